@@ -12,14 +12,11 @@ typedef struct {
     unsigned long long total;
 } CPUStat;
 
-// Reads per-core CPU stats from /proc/stat.
+// Reads per-core CPU stats from /proc/stat, which stays open: seeking back
+// to the start makes the kernel regenerate it.
 // Returns the number of cores read (up to max_cores).
-int get_cpu_stats(CPUStat stats[], int max_cores) {
-    FILE *fp = fopen("/proc/stat", "r");
-    if (!fp) {
-        perror("Failed to open /proc/stat");
-        return 0;
-    }
+int get_cpu_stats(FILE *fp, CPUStat stats[], int max_cores) {
+    rewind(fp);
     char line[256];
     int count = 0;
     while (fgets(line, sizeof(line), fp)) {
@@ -37,50 +34,52 @@ int get_cpu_stats(CPUStat stats[], int max_cores) {
             stats[count++] = cs;
         }
     }
-    fclose(fp);
     return count;
 }
 
-// Draw a horizontal bar on the given page starting at start_col.
-// bar_length is the number of columns (each column is 8 vertical pixels) to fill.
-void draw_bar(int fd, uint8_t page, uint8_t start_col, uint8_t bar_length) {
-    // Set cursor to the specified page and column.
-    ssd1306_set_cursor(fd, page, start_col);
-    // Prepare a buffer: first byte is data mode indicator, then bar_length bytes of 0xFF.
-    uint8_t buf[129]; // maximum 128 columns + 1
-    buf[0] = 0x40; // Data mode
-    for (int i = 1; i <= bar_length; i++) {
-        buf[i] = 0xFF;
+int main(void) {
+    FILE *fp = fopen("/proc/stat", "r");
+    if (!fp) {
+        perror("Failed to open /proc/stat");
+        return 1;
     }
-    // Write the bar.
-    if (write(fd, buf, bar_length + 1)<0) perror("error drawing bar");
-}
 
-int main(void) {
     // Initialize the display.
-    int fd = ssd1306_init("/dev/i2c-7", 0x3C);
-    if (fd < 0) {
+    ssd1306_t *disp = ssd1306_init("/dev/i2c-7", 0x3C);
+    if (!disp) {
+        fclose(fp);
         return 1;
     }
     
     // Get initial CPU stats.
     CPUStat prev_stats[MAX_CORES] = {0}, curr_stats[MAX_CORES] = {0};
-    int num_cores = get_cpu_stats(prev_stats, MAX_CORES);
+    int num_cores = get_cpu_stats(fp, prev_stats, MAX_CORES);
     if (num_cores <= 0) {
         printf("No CPU cores found.\n");
-        ssd1306_close(fd);
+        ssd1306_close(disp);
+        fclose(fp);
         return 1;
     }
+
+    // One row per core: "C0  72% [bar]". The name and the percent sign
+    // never change; the readout and the bar redraw only what moved.
+    ssd1306_ui_t *ui = ssd1306_ui_create(disp);
+    ssd1306_widget_t *usage_text[MAX_CORES], *usage_bar[MAX_CORES];
+    for (int i = 0; i < num_cores; i++) {
+        char name[8];
+        snprintf(name, sizeof(name), "C%d", i);
+        ssd1306_label_set(ssd1306_label_create(ui, 0, i * 8, 12, NULL), name);
+        usage_text[i] = ssd1306_readout_create(ui, 14, i * 8, 3, 0, NULL);
+        ssd1306_label_set(ssd1306_label_create(ui, 32, i * 8, 6, NULL), "%");
+        usage_bar[i] = ssd1306_bar_create(ui, 40, i * 8, 88, 7, 0, 100);
+    }
     
     // Main update loop (update every second).
     while (1) {
         sleep(1);
-        num_cores = get_cpu_stats(curr_stats, MAX_CORES);
-        
-        // Clear the display.
-        // ssd1306_clear_display(fd);
+        num_cores = get_cpu_stats(fp, curr_stats, MAX_CORES);
         
-        // For each core, compute usage and draw a label and a bar.
+        // For each core, compute usage and update its readout and bar.
         for (int i = 0; i < num_cores; i++) {
             unsigned long long prev_total = prev_stats[i].total;
             unsigned long long curr_total = curr_stats[i].total;
@@ -94,29 +93,24 @@ int main(void) {
             if (total_diff != 0) {
                 usage = (int)(((total_diff - idle_diff) * 100) / total_diff);
             }
-            
-            // Build a label string like "C0: 72%"
-            char label[16];
-            snprintf(label, sizeof(label), "C%d:%3d%%", i, usage);
-            // Set cursor on page i, column 0 and draw the label.
-            ssd1306_set_cursor(fd, i, 0);
-            ssd1306_draw_string(fd, label);
-            
-            // Draw the usage bar starting at column 40.
-            // For example, let the maximum bar width be 80 columns.
-            uint8_t max_bar_width = 80;
-            uint8_t bar_width = (usage * max_bar_width) / 100;
-            draw_bar(fd, i, 40, bar_width);
+            ssd1306_readout_set(usage_text[i], usage);
+            ssd1306_bar_set(usage_bar[i], usage);
             
             // Update previous stats for next iteration.
             prev_stats[i] = curr_stats[i];
         }
+
+        // Redraw what changed and send it in one transfer.
+        ssd1306_ui_render(ui);
+        ssd1306_flush(disp);
     }
     
     // Clear display and close.
-    ssd1306_clear_display(fd);
-    ssd1306_close(fd);
+    ssd1306_ui_destroy(ui);
+    ssd1306_clear_display(disp);
+    ssd1306_flush(disp);
+    ssd1306_close(disp);
+    fclose(fp);
     
     return 0;
 }
-
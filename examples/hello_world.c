@@ -4,20 +4,21 @@
 
 int main(void) {
 
-    int fd = ssd1306_init("/dev/i2c-2", 0x3C);
-    if (fd < 0) {
+    ssd1306_t *disp = ssd1306_init("/dev/i2c-2", 0x3C);
+    if (!disp) {
         return 1;
     }
 
-    ssd1306_clear_display(fd);
-    ssd1306_set_cursor(fd, 0, 0);
-    ssd1306_draw_string(fd, "Hello World");
+    ssd1306_clear_display(disp);
+    ssd1306_set_cursor(disp, 0, 0);
+    ssd1306_draw_string(disp, "Hello World");
+    ssd1306_flush(disp);
     
     sleep(5);
     
-    ssd1306_clear_display(fd);
-    ssd1306_close(fd);
+    ssd1306_clear_display(disp);
+    ssd1306_flush(disp);
+    ssd1306_close(disp);
     
     return 0;
 }
-
@@ -0,0 +1,23 @@
+#include <stdio.h>
+#include "ssd1306.h"
+
+// Show the last lines of standard input, e.g. `journalctl -f | ./log_tail`.
+int main(void) {
+    ssd1306_t *disp = ssd1306_init("/dev/i2c-1", 0x3C);
+    if (!disp) {
+        return 1;
+    }
+
+    ssd1306_console_init(disp);
+    ssd1306_console_set_smooth(disp, 5000);
+    ssd1306_flush(disp);
+
+    char line[256];
+    while (fgets(line, sizeof(line), stdin)) {
+        ssd1306_console_write(disp, line);
+        ssd1306_flush(disp);
+    }
+
+    ssd1306_close(disp);
+    return 0;
+}
@@ -0,0 +1,35 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "ssd1306.h"
+
+// Pop up a message box over whatever other oledd clients show, e.g.
+// `./notify "Backup done"`, then take it down again.
+int main(int argc, char **argv) {
+    const char *text = argc > 1 ? argv[1] : "Hello from notify";
+
+    ssd1306_t *disp = ssd1306_init_client("/run/oledd.sock", 100);
+    if (!disp) {
+        return 1;
+    }
+
+    // A box around one line of text, centered; the rest of the panel keeps
+    // showing the layers below.
+    ssd1306_geometry_t geom;
+    ssd1306_get_geometry(disp, &geom);
+    int w = (int)strlen(text) * 6 + 6;
+    if (w > geom.width) {
+        w = geom.width;
+    }
+    int x = (geom.width - w) / 2;
+    ssd1306_client_set_region(disp, x, 12, w, 16);
+    ssd1306_draw_rect(disp, x, 12, w, 16, SSD1306_WHITE);
+    ssd1306_set_cursor(disp, 2, (uint8_t)(x + 3));
+    ssd1306_draw_string(disp, text);
+    ssd1306_flush(disp);
+
+    sleep(3);
+
+    ssd1306_close(disp);
+    return 0;
+}
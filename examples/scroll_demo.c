@@ -2,24 +2,52 @@
 #include <unistd.h>
 #include "ssd1306.h"
 
+// Ticker speed in columns per second, and how long it runs.
+#define TICKER_SPEED 20
+#define TICKER_MS    10000
+
 int main(void) {
-    int fd = ssd1306_init("/dev/i2c-2", 0x3C);
-    if (fd < 0) return 1;
-    
-    ssd1306_clear_display(fd);
-    ssd1306_set_cursor(fd, 0, 0);
-    ssd1306_draw_string(fd, "KL RAHUL ROCKS!");
-    
+    ssd1306_t *disp = ssd1306_init("/dev/i2c-2", 0x3C);
+    if (!disp) return 1;
+
+    ssd1306_clear_display(disp);
+    ssd1306_set_cursor(disp, 0, 0);
+    ssd1306_draw_string(disp, "KL RAHUL ROCKS!");
+    ssd1306_flush(disp);
+
     sleep(2);
-    
-    // Start left scroll on page 0 (0x00 fastest).
-    ssd1306_start_scroll_left(fd, 0x00, 0x00, 0x00);
-    sleep(10);
-    ssd1306_stop_scroll(fd);
-    
+
+    // Let the planner decide whether the controller scrolls page 0 or
+    // whether we rotate it ourselves.
+    ssd1306_scroll_t ticker = {
+        .mode = SSD1306_SCROLL_LEFT,
+        .start_page = 0,
+        .end_page = 0,
+        .start_col = 0,
+        .end_col = SSD1306_WIDTH - 1,
+    };
+    ssd1306_scroll_plan_t plan;
+    ssd1306_scroll_plan(&ticker, SSD1306_WIDTH, TICKER_SPEED, TICKER_MS, &plan);
+    printf("%s scrolling: %zu bytes in hardware, %zu in software\n",
+           plan.hardware ? "Hardware" : "Software", plan.hw_bytes, plan.sw_bytes);
+
+    if (plan.hardware) {
+        ticker.frames = plan.frames;
+        ssd1306_set_scroll(disp, &ticker);
+        ssd1306_flush(disp);
+        usleep(TICKER_MS * 1000);
+        ssd1306_stop_scroll(disp);
+    } else {
+        for (int step = 0; step < TICKER_SPEED * TICKER_MS / 1000; step++) {
+            ssd1306_rotate_region(disp, 0, 0, 0, SSD1306_WIDTH - 1, -1);
+            ssd1306_flush(disp);
+            usleep(1000000 / TICKER_SPEED);
+        }
+    }
+
     sleep(2);
-    ssd1306_clear_display(fd);
-    ssd1306_close(fd);
+    ssd1306_clear_display(disp);
+    ssd1306_flush(disp);
+    ssd1306_close(disp);
     return 0;
 }
-
@@ -7,64 +7,30 @@
 #include <sys/ioctl.h>
 #include "ssd1306.h"
 
-#define OLED_WIDTH 128
-#define OLED_HEIGHT 64
-#define PAGE_COUNT 8
-
 // Define the grid: each block is 4x4 pixels.
 #define GRID_WIDTH 32    // 128/4
 #define GRID_HEIGHT 16   // 64/4
 #define BLOCK_SIZE 4
 
-// Global framebuffer: one byte per column per page (8 pages for 64 pixels height)
-uint8_t fb[PAGE_COUNT][OLED_WIDTH];
-
-// Clear the framebuffer.
-void clear_fb(void) {
-    for (int p = 0; p < PAGE_COUNT; p++) {
-        for (int col = 0; col < OLED_WIDTH; col++) {
-            fb[p][col] = 0x00;
-        }
-    }
-}
+ssd1306_t *disp;
+ssd1306_scene_t *scene;
 
-// Set a single pixel (x,y) in the framebuffer to value (0 or 1).
-void set_pixel(int x, int y, int value) {
-    if (x < 0 || x >= OLED_WIDTH || y < 0 || y >= OLED_HEIGHT)
-        return;
-    int page = y / 8;
-    int bit = y % 8;
-    if (value)
-        fb[page][x] |= (1 << bit);
-    else
-        fb[page][x] &= ~(1 << bit);
-}
+// Every cell on screen is a sprite showing this block, so a tick redraws
+// only the cells that moved.
+static const uint8_t block[BLOCK_SIZE] = { 0x0F, 0x0F, 0x0F, 0x0F };
 
-// Draw a block in grid coordinates; each block is BLOCK_SIZE x BLOCK_SIZE pixels.
-void draw_block(int gridX, int gridY, int value) {
-    int x = gridX * BLOCK_SIZE;
-    int y = gridY * BLOCK_SIZE;
-    for (int dy = 0; dy < BLOCK_SIZE; dy++) {
-        for (int dx = 0; dx < BLOCK_SIZE; dx++) {
-            set_pixel(x + dx, y + dy, value);
-        }
-    }
+// Move a block to grid coordinates.
+void move_block(ssd1306_sprite_t *s, int gridX, int gridY) {
+    ssd1306_sprite_move(s, gridX * BLOCK_SIZE, gridY * BLOCK_SIZE);
 }
 
-// Update the OLED display by writing the framebuffer.
-// For each page (8-pixel high row), set the cursor and write 128 data bytes.
-void update_display(int fd) {
-    for (int page = 0; page < PAGE_COUNT; page++) {
-        ssd1306_set_cursor(fd, page, 0);
-        uint8_t buf[129];
-        buf[0] = 0x40;  // Data mode indicator.
-        for (int col = 0; col < OLED_WIDTH; col++) {
-            buf[col + 1] = fb[page][col];
-        }
-        if (write(fd, buf, 129) != 129) {
-            perror("update_display: write error");
-        }
+// Add a block at grid coordinates.
+ssd1306_sprite_t *add_block(int gridX, int gridY) {
+    ssd1306_sprite_t *s = ssd1306_sprite_create(scene, block, BLOCK_SIZE, BLOCK_SIZE, 0, SSD1306_BLEND_OR);
+    if (s) {
+        move_block(s, gridX, gridY);
     }
+    return s;
 }
 
 // ==================== Snake Game Logic ====================
@@ -76,9 +42,11 @@ typedef struct {
 
 #define MAX_SNAKE 100
 Point snake[MAX_SNAKE];
+ssd1306_sprite_t *cells[MAX_SNAKE];
 int snake_length;
 int direction; // 0: up, 1: right, 2: down, 3: left
 Point food;
+ssd1306_sprite_t *food_block;
 int game_over = 0;
 
 // Place food at a random position not occupied by the snake.
@@ -95,6 +63,7 @@ void place_food(void) {
             }
         }
     }
+    move_block(food_block, food.x, food.y);
 }
 
 // Check if a point collides with the boundaries or the snake body.
@@ -131,16 +100,91 @@ int kbhit(void) {
     return byteswaiting;
 }
 
+// ==================== Game Tick and Rendering ====================
+
+// The snake moves one cell every 200 ms, whatever rate the display runs at.
+#define STEP_NS 200000000ULL
+
+// Advance the game by one step.
+void step(void) {
+    // Handle user input.
+    if (kbhit()) {
+        char ch;
+        if (read(STDIN_FILENO, &ch, 1) < 0) { game_over = 1; return; }
+        if (ch == 'w' && direction != 2) direction = 0;
+        else if (ch == 'd' && direction != 3) direction = 1;
+        else if (ch == 's' && direction != 0) direction = 2;
+        else if (ch == 'a' && direction != 1) direction = 3;
+        else if (ch == 'q') { game_over = 1; return; }
+    }
+    
+    // Calculate new head position.
+    Point new_head = snake[0];
+    if (direction == 0) new_head.y -= 1;
+    else if (direction == 1) new_head.x += 1;
+    else if (direction == 2) new_head.y += 1;
+    else if (direction == 3) new_head.x -= 1;
+    
+    // Check collision with walls or self.
+    if (check_collision(new_head)) {
+        game_over = 1;
+        return;
+    }
+    
+    // Move snake: shift the body. The tail block becomes the new head.
+    ssd1306_sprite_t *tail = cells[snake_length - 1];
+    for (int i = snake_length - 1; i > 0; i--) {
+        snake[i] = snake[i - 1];
+        cells[i] = cells[i - 1];
+    }
+    snake[0] = new_head;
+    cells[0] = tail;
+    move_block(tail, new_head.x, new_head.y);
+    
+    // Check if food is eaten.
+    if (new_head.x == food.x && new_head.y == food.y) {
+        if (snake_length < MAX_SNAKE) {
+            snake[snake_length] = snake[snake_length - 1]; // duplicate tail.
+            cells[snake_length] = add_block(snake[snake_length].x, snake[snake_length].y);
+            if (cells[snake_length]) {
+                snake_length++;
+            }
+        }
+        place_food();
+    }
+}
+
+// Called by the pacer right before each flush slot: catch up on the steps
+// due by then, reading the keyboard as late as possible, and recomposite
+// the cells that moved.
+int render(ssd1306_t *d, uint64_t slot_ns, void *arg) {
+    static uint64_t next_step;
+    (void)arg;
+    if (next_step == 0) {
+        next_step = slot_ns;
+    }
+    while (!game_over && next_step <= slot_ns) {
+        step();
+        next_step += STEP_NS;
+    }
+
+    (void)d;
+    ssd1306_scene_render(scene);
+    return game_over;
+}
+
 // ==================== Main Game Loop ====================
 
 int main(void) {
     srand(time(NULL));
     
     // Initialize the OLED display.
-    int fd = ssd1306_init("/dev/i2c-7", 0x3C);
-    if (fd < 0) {
+    disp = ssd1306_init("/dev/i2c-7", 0x3C);
+    if (!disp) {
         return 1;
     }
+    // Let a worker thread drive the bus so frames never stall the game tick.
+    ssd1306_async_start(disp);
     
     // Set terminal to raw non-blocking mode.
     enable_raw_mode();
@@ -148,85 +192,44 @@ int main(void) {
     fcntl(STDIN_FILENO, F_SETFL, flags | O_NONBLOCK);
     
     // Initialize snake in the middle of the grid.
+    scene = ssd1306_scene_create(disp);
+    if (!scene || !(food_block = add_block(0, 0))) {
+        ssd1306_close(disp);
+        return 1;
+    }
     snake_length = 3;
-    snake[0].x = GRID_WIDTH / 2;
-    snake[0].y = GRID_HEIGHT / 2;
-    snake[1].x = snake[0].x - 1;
-    snake[1].y = snake[0].y;
-    snake[2].x = snake[0].x - 2;
-    snake[2].y = snake[0].y;
+    for (int i = 0; i < snake_length; i++) {
+        snake[i].x = GRID_WIDTH / 2 - i;
+        snake[i].y = GRID_HEIGHT / 2;
+        if (!(cells[i] = add_block(snake[i].x, snake[i].y))) {
+            ssd1306_close(disp);
+            return 1;
+        }
+    }
     direction = 1; // moving right.
     place_food();
     
-    // Game loop: update every 200 ms.
-    while (!game_over) {
-        // Handle user input.
-        if (kbhit()) {
-            char ch;
-            if (read(STDIN_FILENO, &ch, 1) < 0) break;
-            if (ch == 'w' && direction != 2) direction = 0;
-            else if (ch == 'd' && direction != 3) direction = 1;
-            else if (ch == 's' && direction != 0) direction = 2;
-            else if (ch == 'a' && direction != 1) direction = 3;
-            else if (ch == 'q') { game_over = 1; break; }
-        }
-        
-        // Calculate new head position.
-        Point new_head = snake[0];
-        if (direction == 0) new_head.y -= 1;
-        else if (direction == 1) new_head.x += 1;
-        else if (direction == 2) new_head.y += 1;
-        else if (direction == 3) new_head.x -= 1;
-        
-        // Check collision with walls or self.
-        if (check_collision(new_head)) {
-            game_over = 1;
-            break;
-        }
-        
-        // Move snake: shift the body.
-        for (int i = snake_length - 1; i > 0; i--) {
-            snake[i] = snake[i - 1];
-        }
-        snake[0] = new_head;
-        
-        // Check if food is eaten.
-        if (new_head.x == food.x && new_head.y == food.y) {
-            if (snake_length < MAX_SNAKE) {
-                snake[snake_length] = snake[snake_length - 1]; // duplicate tail.
-                snake_length++;
-            }
-            place_food();
-        }
-        
-        // Clear the framebuffer.
-        clear_fb();
-        
-        // Draw snake.
-        for (int i = 0; i < snake_length; i++) {
-            draw_block(snake[i].x, snake[i].y, 1);
-        }
-        // Draw food.
-        draw_block(food.x, food.y, 1);
-        
-        // Update OLED display.
-        update_display(fd);
-        
-        // Wait 200 ms.
-        usleep(200000);
+    // Game loop: the pacer draws each frame just before the display takes
+    // it, and falls back to a lower rate if the bus cannot keep up.
+    ssd1306_pacer_t *pacer = ssd1306_pacer_create(disp, 5);
+    if (pacer) {
+        ssd1306_pacer_run(pacer, render, NULL);
+        ssd1306_pacer_destroy(pacer);
     }
     
+    ssd1306_scene_destroy(scene);
+
     // Game over: show "Game Over" message
-    clear_fb();
-    ssd1306_clear_display(fd);
-    ssd1306_set_cursor(fd, 3, 10);
-    ssd1306_draw_string(fd, "Game Over");
+    ssd1306_clear_display(disp);
+    ssd1306_set_cursor(disp, 3, 10);
+    ssd1306_draw_string(disp, "Game Over");
+    ssd1306_flush(disp);
     sleep(5);
-    update_display(fd);
+    ssd1306_clear_display(disp);
+    ssd1306_flush(disp);
     sleep(3);
     
-    ssd1306_clear_display(fd);
-    ssd1306_close(fd);
+    ssd1306_close(disp);
     disable_raw_mode();
     
     return 0;
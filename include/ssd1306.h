@@ -1,42 +1,1017 @@
 #ifndef SSD1306_H
 #define SSD1306_H
 
+#include <stddef.h>
 #include <stdint.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Controller RAM size: the largest panel, and the layout of every
+// framebuffer. Smaller panels use its top-left corner.
+#define SSD1306_WIDTH  128
+#define SSD1306_HEIGHT 64
+#define SSD1306_PAGES  (SSD1306_HEIGHT / 8)
+
+// Opaque display handle. Each display owns a page-major framebuffer:
+// byte [page * SSD1306_WIDTH + col] holds 8 vertical pixels, LSB on top.
+typedef struct ssd1306 ssd1306_t;
+
 /*
  * Basic display functions
  */
 
-// Initialize the SSD1306 display.
-int ssd1306_init(const char *i2c_dev, uint8_t address);
+// Initialize the SSD1306 display on an I2C bus. Returns NULL on failure.
+ssd1306_t *ssd1306_init(const char *i2c_dev, uint8_t address);
 
-// Close the I2C file descriptor.
-void ssd1306_close(int fd);
+// Close the transport and free the display handle.
+void ssd1306_close(ssd1306_t *disp);
 
-// Clear the entire display.
-void ssd1306_clear_display(int fd);
+// Clear the entire framebuffer.
+void ssd1306_clear_display(ssd1306_t *disp);
 
-// Set the cursor to a given page (row) and column.
-void ssd1306_set_cursor(int fd, uint8_t page, uint8_t col);
+// Set the text cursor to a given page (row) and column.
+void ssd1306_set_cursor(ssd1306_t *disp, uint8_t page, uint8_t col);
 
 // Draw a single character at the current cursor position.
-void ssd1306_draw_char(int fd, char c);
+void ssd1306_draw_char(ssd1306_t *disp, char c);
+
+// Draw a null-terminated string at the cursor, wrapping to the next page.
+void ssd1306_draw_string(ssd1306_t *disp, const char *str);
 
-// Draw a null-terminated string.
-void ssd1306_draw_string(int fd, const char *str);
+// Draw a null-terminated string with its top-left corner at pixel (x, y).
+// y need not be a multiple of 8. The text is clipped at the panel edges
+// instead of wrapping. Returns the column just past the text.
+int ssd1306_draw_text(ssd1306_t *disp, int x, int y, const char *str);
 
 /*
- * Scrolling functions
+ * Panel geometry
+ *
+ * Displays start out as 128x64. Smaller glass is wired to part of the
+ * controller's 128x64 RAM: fewer COM rows, and on narrow panels a window
+ * of columns starting at a fixed offset. Drawing is clipped to the panel
+ * and flushes only send what the panel shows, so a 128x32 frame is 512
+ * bytes. include/ssd1306.hpp fixes the geometry at compile time.
  */
 
-// Initiates leftward horizontal scrolling on the display.
-void ssd1306_start_scroll_left(int fd, uint8_t start_page, uint8_t end_page, uint8_t scroll_speed);
+typedef struct {
+    uint8_t width;          // Visible columns.
+    uint8_t height;         // Visible rows, a multiple of 8.
+    uint8_t col_offset;     // Controller column of the leftmost visible one.
+    uint8_t com_pins;       // COM pins configuration (0xDA): 0x02 sequential, 0x12 alternative.
+} ssd1306_geometry_t;
 
-// Initiates rightward horizontal scrolling on the display.
-void ssd1306_start_scroll_right(int fd, uint8_t start_page, uint8_t end_page, uint8_t scroll_speed);
+// Common modules.
+extern const ssd1306_geometry_t ssd1306_128x64;
+extern const ssd1306_geometry_t ssd1306_128x32;
+extern const ssd1306_geometry_t ssd1306_72x40;
+extern const ssd1306_geometry_t ssd1306_64x48;
 
-// Stops any active scrolling on the display.
-void ssd1306_stop_scroll(int fd);
+// Reconfigure the panel for a geometry and clear the display. Call it right
+// after opening the display, before ssd1306_async_start().
+// Returns 0 on success, -1 on error.
+int ssd1306_set_geometry(ssd1306_t *disp, const ssd1306_geometry_t *geom);
 
-#endif // SSD1306_H
+// The geometry the display is configured for.
+void ssd1306_get_geometry(const ssd1306_t *disp, ssd1306_geometry_t *geom);
+
+/*
+ * Transports
+ *
+ * Every display talks to the panel through a transport: a small vtable
+ * that sends a list of command/data segments. The library ships I2C,
+ * spidev, user-callback and in-memory backends; other buses can plug in
+ * through ssd1306_init_transport().
+ */
+
+// Segment kinds. On I2C these are the control bytes that start each message;
+// on SPI they select the level of the D/C line.
+#define SSD1306_CTRL_CMD  0x00
+#define SSD1306_CTRL_DATA 0x40
+
+// One run of command or data bytes.
+typedef struct {
+    uint8_t ctrl;       // SSD1306_CTRL_CMD or SSD1306_CTRL_DATA.
+    const uint8_t *buf;
+    size_t len;
+} ssd1306_seg_t;
+
+// Bus cost model of a transport, used to pick the cheapest encoding of a
+// frame update. Times are in nanoseconds.
+typedef struct {
+    uint32_t xfer_ns;   // Fixed cost of one transfer (system call, bus setup).
+    uint32_t seg_ns;    // Cost of starting a segment (I2C message, D/C switch).
+    uint32_t byte_ns;   // Cost of one payload byte on the wire.
+} ssd1306_cost_t;
+
+// Error counters a transport keeps, read after every transfer.
+typedef struct {
+    uint64_t short_writes;  // Writes the bus took only part of.
+    uint64_t retries;       // Batches resent after the adapter refused them.
+} ssd1306_bus_stats_t;
+
+typedef struct {
+    const char *name;
+    // Send segments in order. Returns 0 on success, -1 on error.
+    int (*xfer)(void *ctx, const ssd1306_seg_t *segs, size_t nsegs);
+    // Cap the size of one bus message. May be NULL.
+    void (*set_max_transfer)(void *ctx, size_t bytes);
+    // Release the backend. May be NULL.
+    void (*close)(void *ctx);
+    // Name of the physical bus, shared by every display on it. May be NULL
+    // (or return NULL) when the transport does not share a bus.
+    const char *(*bus_id)(void *ctx);
+    // Fill in the bus cost model. May be NULL: the display then assumes an
+    // I2C bus at 400 kHz.
+    void (*cost)(void *ctx, ssd1306_cost_t *cost);
+    // Read the transport's running error counters. May be NULL.
+    void (*stats)(void *ctx, ssd1306_bus_stats_t *stats);
+    // Name of the panel on its bus, such as its I2C address. May be NULL
+    // (or return NULL) when the bus has a single panel.
+    const char *(*dev_id)(void *ctx);
+} ssd1306_transport_ops_t;
+
+// Initialize a display on a custom transport. The display owns ctx from
+// now on: ops->close(ctx) is called by ssd1306_close() or on failure.
+ssd1306_t *ssd1306_init_transport(const ssd1306_transport_ops_t *ops, void *ctx);
+
+// Drives the D/C line of a 4-wire SPI panel: data != 0 selects data, 0 selects command.
+typedef int (*ssd1306_dc_fn)(void *user, int data);
+
+// Initialize a display on a 4-wire SPI panel through /dev/spidevX.Y.
+// set_dc is called whenever the stream switches between commands and data.
+ssd1306_t *ssd1306_init_spi(const char *spi_dev, uint32_t speed_hz, ssd1306_dc_fn set_dc, void *user);
+
+// Called once per segment by the callback transport. Returns 0 on success, -1 on error.
+typedef int (*ssd1306_write_fn)(void *user, uint8_t ctrl, const uint8_t *buf, size_t len);
+
+// Initialize a display whose bytes are handed to a user callback.
+ssd1306_t *ssd1306_init_callback(ssd1306_write_fn write, void *user);
+
+// One segment recorded by the memory transport.
+typedef struct {
+    uint8_t ctrl;    // SSD1306_CTRL_CMD or SSD1306_CTRL_DATA.
+    size_t offset;   // Position of the first byte in ssd1306_mem_log_t.bytes.
+    size_t len;
+    size_t xfer;     // Index of the transfer (syscall) that carried it.
+} ssd1306_mem_seg_t;
+
+// Everything a memory transport has been asked to send.
+typedef struct {
+    uint8_t *bytes;          // Payload bytes in order, without control bytes.
+    size_t nbytes;
+    ssd1306_mem_seg_t *segs; // One record per segment.
+    size_t nsegs;
+    size_t xfers;            // Number of transfers.
+} ssd1306_mem_log_t;
+
+// Initialize a display that records every byte and transfer in memory.
+ssd1306_t *ssd1306_init_mem(void);
+
+// The log of a memory-transport display, or NULL for other transports.
+const ssd1306_mem_log_t *ssd1306_mem_log(const ssd1306_t *disp);
+
+// Discard everything recorded so far.
+void ssd1306_mem_reset(ssd1306_t *disp);
+
+/*
+ * Emulator
+ *
+ * A headless model of the controller that interprets the command and data
+ * stream the way the chip does: page, horizontal and vertical addressing,
+ * 0x21/0x22 windows, start line, segment remap, COM scan direction, the
+ * hardware scroll commands and the one-column content scroll. It turns a
+ * byte stream into the picture the glass would show, for golden-image
+ * tests and for checking encoders, and counts every byte that reached it.
+ */
+
+typedef struct ssd1306_emu ssd1306_emu_t;
+
+// Controller registers as the emulator currently holds them.
+typedef struct {
+    uint8_t addr_mode;          // 0 horizontal, 1 vertical, 2 page.
+    uint8_t col_start, col_end; // Column window (0x21).
+    uint8_t page_start, page_end; // Page window (0x22).
+    uint8_t start_line;         // Display start line (0x40-0x7F).
+    uint8_t offset;             // Display offset (0xD3).
+    uint8_t mux;                // Multiplex ratio: rows driven (0xA8).
+    uint8_t com_pins;           // COM pins configuration (0xDA).
+    uint8_t contrast;           // 0x81.
+    uint8_t seg_remap;          // 1 after 0xA1.
+    uint8_t com_remap;          // 1 after 0xC8.
+    uint8_t display_on;         // 1 after 0xAF.
+    uint8_t inverted;           // 1 after 0xA7.
+    uint8_t entire_on;          // 1 after 0xA5.
+    uint8_t charge_pump;        // 1 after 0x8D 0x14.
+    uint8_t scrolling;          // 1 between 0x2F and 0x2E.
+    uint16_t scroll_interval;   // Frames per scroll step.
+    uint8_t scroll_start_page, scroll_end_page;
+    uint8_t scroll_start_col, scroll_end_col;
+    uint8_t area_top, area_rows; // Vertical scroll area (0xA3).
+    uint8_t vscroll;            // Rows the vertical scroll has moved so far.
+} ssd1306_emu_state_t;
+
+// Bytes and transfers the emulator has received.
+typedef struct {
+    uint64_t xfers;             // Transfers (only through ssd1306_init_emu()).
+    uint64_t segs;              // Command or data segments.
+    uint64_t cmd_bytes;
+    uint64_t data_bytes;
+    uint64_t redundant_bytes;   // Data bytes that rewrote RAM with the value it held.
+    uint64_t i2c_bytes;         // Bytes on an I2C bus: payload plus address and control byte per segment.
+    uint64_t bad_cmds;          // Opcodes the controller does not know.
+    uint64_t content_shifts;    // One-column content scrolls (0x2C/0x2D) carried out.
+} ssd1306_emu_stats_t;
+
+// Create an emulator in the controller's reset state: page addressing,
+// display off, RAM cleared. Returns NULL on error.
+ssd1306_emu_t *ssd1306_emu_create(void);
+void ssd1306_emu_destroy(ssd1306_emu_t *emu);
+
+// Return to the reset state and clear the counters.
+void ssd1306_emu_reset(ssd1306_emu_t *emu);
+
+// Feed one segment; user is the emulator. Fits ssd1306_init_callback() and
+// replaying a ssd1306_mem_log_t. Commands may be split across segments.
+int ssd1306_emu_write(void *user, uint8_t ctrl, const uint8_t *buf, size_t len);
+
+// Initialize a display whose transport feeds emu. The emulator is not owned
+// by the display and may outlive it, like a panel that stays powered.
+ssd1306_t *ssd1306_init_emu(ssd1306_emu_t *emu);
+
+// Let frames display refreshes pass, stepping a running hardware scroll.
+void ssd1306_emu_advance(ssd1306_emu_t *emu, unsigned frames);
+
+// Pixel (x, y) of the picture the controller drives, 128 columns by mux rows,
+// after start line, remap, scroll, inversion and display on/off.
+int ssd1306_emu_pixel(const ssd1306_emu_t *emu, int x, int y);
+
+// Write the picture as a binary PBM. geom crops it to the glass of a panel;
+// NULL writes every column and driven row. Returns 0 on success, -1 on error.
+int ssd1306_emu_write_pbm(const ssd1306_emu_t *emu, const char *path, const ssd1306_geometry_t *geom);
+
+// The controller RAM, SSD1306_PAGES pages of SSD1306_WIDTH bytes.
+const uint8_t *ssd1306_emu_ram(const ssd1306_emu_t *emu);
+
+void ssd1306_emu_get_state(const ssd1306_emu_t *emu, ssd1306_emu_state_t *state);
+void ssd1306_emu_get_stats(const ssd1306_emu_t *emu, ssd1306_emu_stats_t *stats);
+void ssd1306_emu_reset_stats(ssd1306_emu_t *emu);
+
+/*
+ * Warm attach
+ *
+ * Short-lived programs can hand the panel on without resetting it. A
+ * display closed with ssd1306_detach() leaves a small state file: the
+ * boot, bus, geometry, address window, start line, contrast, scroll and
+ * the RAM content the library last sent. The next ssd1306_attach() takes
+ * the file over and continues with incremental flushes: no init sequence,
+ * no clear. A file from another boot, bus or geometry, a damaged one, or
+ * none at all (a program that crashed leaves none) falls back to a cold
+ * init. State kept outside the library, such as commands sent through a
+ * command buffer, is not recorded.
+ */
+
+// Default state file. Each panel needs its own.
+#define SSD1306_STATE_PATH "/run/ssd1306.state"
+
+// Open a panel on an I2C bus, taking over the state in state_path (NULL:
+// SSD1306_STATE_PATH) when it matches, or initializing the panel for geom
+// (NULL: 128x64) when not. The state file is consumed either way.
+// Returns NULL on failure.
+ssd1306_t *ssd1306_attach(const char *i2c_dev, uint8_t address, const ssd1306_geometry_t *geom,
+                          const char *state_path);
+
+// ssd1306_attach() on a custom transport, which the display owns from now on.
+ssd1306_t *ssd1306_attach_transport(const ssd1306_transport_ops_t *ops, void *ctx,
+                                    const ssd1306_geometry_t *geom, const char *state_path);
+
+// 1 if the display took over a running panel, 0 if it was initialized.
+// The framebuffer of a warm display starts out as what the panel shows.
+int ssd1306_is_warm(const ssd1306_t *disp);
+
+// Record what the panel shows and how it is configured in state_path
+// (NULL: SSD1306_STATE_PATH), replacing the file atomically. Fails if a
+// transfer has failed since the panel was last repainted in full, since
+// the panel content is then unknown.
+// Returns 0 on success, -1 on error.
+int ssd1306_save_state(ssd1306_t *disp, const char *state_path);
+
+// Stop the flush worker, save the state and close the display. Changes not
+// flushed are not sent. Returns the result of saving; the display is
+// closed either way.
+int ssd1306_detach(ssd1306_t *disp, const char *state_path);
+
+/*
+ * Fonts
+ *
+ * Fonts are compiled from BDF or PSF sources by tools/fontc at build time.
+ * Each glyph is stored the way the panel stores pixels: height/8 pages of
+ * one byte per column, so drawing copies whole column bytes.
+ */
+
+typedef struct {
+    uint8_t height;          // Cell height in pixels, a multiple of 8.
+    uint8_t first, last;     // Range of characters in the font.
+    const uint8_t *widths;   // Advance width of each glyph in columns, spacing included.
+    const uint16_t *offsets; // Start of each glyph in bitmap.
+    const uint8_t *bitmap;   // Glyph columns, height/8 pages per glyph.
+} ssd1306_font_t;
+
+// Built-in proportional fonts, 8, 16 and 24 pixels tall.
+extern const ssd1306_font_t ssd1306_font_8;
+extern const ssd1306_font_t ssd1306_font_16;
+extern const ssd1306_font_t ssd1306_font_24;
+
+// Draw a string in the given font with its top-left corner at pixel (x, y),
+// clipped at the panel edges. Returns the column just past the text.
+int ssd1306_draw_text_font(ssd1306_t *disp, const ssd1306_font_t *font, int x, int y, const char *str);
+
+// Width in columns of a string drawn in the given font.
+int ssd1306_text_width(const ssd1306_font_t *font, const char *str);
+
+/*
+ * Framebuffer functions
+ *
+ * Drawing only touches RAM. Nothing reaches the panel until ssd1306_flush(),
+ * which sends just the column ranges that changed since the last flush.
+ */
+
+// Set (on != 0) or clear a single pixel. Out-of-range coordinates are ignored.
+void ssd1306_set_pixel(ssd1306_t *disp, int x, int y, int on);
+
+// Direct access to the framebuffer (SSD1306_PAGES * SSD1306_WIDTH bytes;
+// only the panel's pages and columns are sent). Call ssd1306_mark_dirty()
+// for any range written through this pointer.
+uint8_t *ssd1306_get_buffer(ssd1306_t *disp);
+
+// Mark columns col_start..col_end (inclusive) of a page as modified.
+void ssd1306_mark_dirty(ssd1306_t *disp, uint8_t page, uint8_t col_start, uint8_t col_end);
+
+// Send all modified ranges to the panel in a single transfer, encoded in
+// whichever way the transport's cost model rates cheapest: a cursor write
+// per changed span, one address window around all of them, or the whole
+// frame. Returns 0 on success, -1 on error.
+int ssd1306_flush(ssd1306_t *disp);
+
+// Cap the size of a single bus message. Larger payloads are split. On I2C
+// the limit includes the control byte and also shrinks on its own when the
+// adapter rejects long messages.
+void ssd1306_set_max_transfer(ssd1306_t *disp, size_t bytes);
+
+// Replace the transport's bus cost model, e.g. for a bus clocked faster
+// than the transport can detect.
+void ssd1306_set_cost(ssd1306_t *disp, const ssd1306_cost_t *cost);
+
+// Set the panel contrast (0x81; the init sequence sets 0xCF). Like the
+// start line, the change goes out with the next ssd1306_flush(), in the
+// same transfer as the frame.
+void ssd1306_set_contrast(ssd1306_t *disp, uint8_t contrast);
+
+// The contrast set by the application.
+uint8_t ssd1306_get_contrast(const ssd1306_t *disp);
+
+// Declare that the controller takes the one-column content scroll commands
+// (0x2C/0x2D), which canvas pans use to move the picture in panel RAM. Off
+// by default: many SSD1306 clones ignore them. Call it before
+// ssd1306_async_start().
+void ssd1306_set_content_scroll(ssd1306_t *disp, int supported);
+
+// How a flush encoded the changes of a frame.
+#define SSD1306_PLAN_NONE   0   // Nothing changed.
+#define SSD1306_PLAN_SPANS  1   // A cursor command and a data run per changed span.
+#define SSD1306_PLAN_WINDOW 2   // One column/page window (0x21/0x22) around all changes.
+#define SSD1306_PLAN_FULL   3   // The whole frame through a full-panel window.
+
+typedef struct {
+    int plan;               // SSD1306_PLAN_*.
+    size_t spans;           // Changed column spans found in the frame.
+    size_t cmd_bytes;       // What the transfer carried.
+    size_t data_bytes;
+    size_t segs;
+    uint32_t spans_ns;      // Modeled bus time of each candidate plan;
+    uint32_t window_ns;     // 0 when the plan was not possible.
+    uint32_t full_ns;
+} ssd1306_flush_report_t;
+
+// Report on the last flush that reached the panel.
+void ssd1306_get_flush_report(ssd1306_t *disp, ssd1306_flush_report_t *report);
+
+/*
+ * Graphics
+ *
+ * Shapes are clipped at the panel edges. Fills work on whole page bytes:
+ * a rectangle costs one masked pass per page it touches, not one
+ * read-modify-write per pixel.
+ */
+
+// Drawing colors.
+#define SSD1306_BLACK  0    // Clear pixels.
+#define SSD1306_WHITE  1    // Set pixels.
+#define SSD1306_INVERT 2    // Toggle pixels.
+
+// Draw a horizontal line of w pixels starting at (x, y).
+void ssd1306_draw_hline(ssd1306_t *disp, int x, int y, int w, int color);
+
+// Draw a vertical line of h pixels starting at (x, y).
+void ssd1306_draw_vline(ssd1306_t *disp, int x, int y, int h, int color);
+
+// Draw the outline of a w x h rectangle with its top-left corner at (x, y).
+void ssd1306_draw_rect(ssd1306_t *disp, int x, int y, int w, int h, int color);
+
+// Fill a w x h rectangle with its top-left corner at (x, y).
+void ssd1306_fill_rect(ssd1306_t *disp, int x, int y, int w, int h, int color);
+
+// Draw a line from (x0, y0) to (x1, y1), both ends included.
+void ssd1306_draw_line(ssd1306_t *disp, int x0, int y0, int x1, int y1, int color);
+
+// Draw the outline of a circle of radius r centered on (cx, cy).
+void ssd1306_draw_circle(ssd1306_t *disp, int cx, int cy, int r, int color);
+
+// Draw a w x h 1bpp bitmap with its top-left corner at (x, y). The bitmap
+// is page-major like the framebuffer: (h + 7) / 8 pages of w column bytes,
+// LSB on top. Set bits are drawn in color; clear bits leave the panel alone.
+void ssd1306_draw_bitmap(ssd1306_t *disp, int x, int y, const uint8_t *bitmap, int w, int h, int color);
+
+// Options of ssd1306_draw_bitmap_rows().
+#define SSD1306_BITMAP_LSB_FIRST 0x1   // Leftmost pixel in bit 0 (XBM); default is bit 7 (PBM).
+#define SSD1306_BITMAP_OPAQUE    0x2   // Clear bits clear pixels; color is ignored.
+
+// Draw a w x h row-major 1bpp bitmap (PBM, XBM, most rasterizers), rows
+// stride bytes apart, with its top-left corner at (x, y). Blocks of 8x8
+// pixels are transposed into page bytes a 64-bit word at a time. Set bits
+// are drawn in color and clear bits leave the panel alone, unless flags
+// has SSD1306_BITMAP_OPAQUE.
+void ssd1306_draw_bitmap_rows(ssd1306_t *disp, int x, int y, const uint8_t *bits, int w, int h,
+                              size_t stride, int flags, int color);
+
+/*
+ * Grayscale images
+ *
+ * 8-bit grayscale images (0 black, 255 white) are scaled to the target
+ * size by averaging, dithered to 1 bit per pixel and written over the
+ * framebuffer. Thresholding and Bayer dithering compare and pack 16
+ * columns per step with SSE2 or NEON.
+ */
+
+#define SSD1306_DITHER_THRESHOLD 0   // Each pixel against mid-gray: hard edges, no texture.
+#define SSD1306_DITHER_BAYER     1   // 8x8 ordered dither: steady from one video frame to the next.
+#define SSD1306_DITHER_FLOYD     2   // Floyd-Steinberg error diffusion: most detail, shimmers in video.
+
+// Scale a sw x sh grayscale image, rows stride bytes apart, to w x h
+// (at most the controller's 128x64), dither it and write it with its
+// top-left corner at (x, y), clipped to the panel. Returns 0 on success,
+// -1 on invalid sizes.
+int ssd1306_draw_gray(ssd1306_t *disp, int x, int y, int w, int h,
+                      const uint8_t *gray, int sw, int sh, size_t stride, int dither);
+
+/*
+ * Temporal grayscale
+ *
+ * Shows 4 or 8 gray levels on the 1-bit panel by cycling bitplanes. A gray
+ * display keeps a level per pixel (0 off, 2^bits - 1 full) as page-major
+ * bitplanes. The planes are shown in turn for equal time, each at a
+ * contrast proportional to its weight, so the average brightness of a
+ * pixel follows its level. A plane switch sends only the bytes where the
+ * next plane differs from the one on the panel, with the contrast command
+ * in the same transfer. While the planes cycle they own the framebuffer.
+ *
+ * Without flicker, a cycle of b planes needs b plane switches within
+ * 1/SSD1306_GRAY_MIN_HZ seconds: SPI sustains 8 levels on most content,
+ * I2C at 400 kHz only sparse content. ssd1306_gray_info() reports the
+ * depth the display's bus has actually sustained.
+ */
+
+typedef struct ssd1306_gray ssd1306_gray_t;
+
+// Slowest cycle rate counted as flicker-free.
+#define SSD1306_GRAY_MIN_HZ 50
+
+// Redraw the planes before a cycle. Return 0 to continue, anything else
+// to stop the loop.
+typedef int (*ssd1306_gray_fn)(ssd1306_gray_t *g, void *arg);
+
+typedef struct {
+    unsigned bits;              // Planes per cycle.
+    unsigned hz;                // Current cycle rate: the target, or lower while the bus is saturated.
+    uint64_t plane_ns;          // Time each plane is shown.
+    uint64_t switch_ns;         // Average time of the slowest plane switch of a cycle.
+    unsigned sustainable_bits;  // Most planes the bus can cycle at SSD1306_GRAY_MIN_HZ; 0 if unknown.
+    uint64_t cycles;
+    uint64_t late;              // Plane switches that overran their slot.
+} ssd1306_gray_info_t;
+
+// Create 2- or 3-bit planes for disp, all black. The display must flush
+// synchronously (no async mode, no client). Returns NULL on failure.
+ssd1306_gray_t *ssd1306_gray_create(ssd1306_t *disp, unsigned bits);
+
+// Free the planes. The display stays open.
+void ssd1306_gray_destroy(ssd1306_gray_t *g);
+
+// Replace the contrast of each plane, least significant plane first. The
+// default halves it from plane to plane (3 bits: 0x3F, 0x7F, 0xFF); panels
+// with a nonlinear response can be calibrated here.
+void ssd1306_gray_set_contrast(ssd1306_gray_t *g, const uint8_t *contrast);
+
+// Drawing into the planes, clipped at the panel edges. Nothing is shown
+// until the next plane switch.
+void ssd1306_gray_clear(ssd1306_gray_t *g);
+void ssd1306_gray_set_pixel(ssd1306_gray_t *g, int x, int y, unsigned level);
+unsigned ssd1306_gray_get_pixel(const ssd1306_gray_t *g, int x, int y);
+void ssd1306_gray_fill_rect(ssd1306_gray_t *g, int x, int y, int w, int h, unsigned level);
+
+// Draw the set bits of a page-major bitmap (as ssd1306_draw_bitmap())
+// at a level; clear bits are transparent.
+void ssd1306_gray_draw_bitmap(ssd1306_gray_t *g, int x, int y, const uint8_t *bitmap, int w, int h,
+                              unsigned level);
+
+// Draw a w x h 8-bit grayscale image, rows stride bytes apart, rounding
+// each pixel to the nearest level.
+void ssd1306_gray_draw_image(ssd1306_gray_t *g, int x, int y, const uint8_t *gray, int w, int h, size_t stride);
+
+// Send the next plane of the cycle now. Returns 0 on success, -1 on error.
+int ssd1306_gray_step(ssd1306_gray_t *g);
+
+// Cycle the planes hz times a second, calling update (if not NULL) before
+// each cycle, until it returns nonzero or ssd1306_gray_stop() is called.
+// When switches take longer than the target allows, every plane is shown
+// longer, keeping the weights right at a lower rate. On return the panel
+// shows the top plane at its previous contrast. Returns update's nonzero
+// result, 0 when stopped, or -1 on error.
+int ssd1306_gray_run(ssd1306_gray_t *g, unsigned hz, ssd1306_gray_fn update, void *arg);
+
+// Make ssd1306_gray_run() return before the next plane. Safe to call from
+// the callback, another thread or a signal handler.
+void ssd1306_gray_stop(ssd1306_gray_t *g);
+
+// Current rate and measurements. Call from the callback or after run returns.
+void ssd1306_gray_info(const ssd1306_gray_t *g, ssd1306_gray_info_t *info);
+
+/*
+ * Sprites
+ *
+ * A scene is a retained set of sprites composited into the framebuffer.
+ * Each sprite has a position, a page-major bitmap (the layout of
+ * ssd1306_draw_bitmap()), a z order and a blend mode. Moving or changing a
+ * sprite damages the area it covered and the area it covers now;
+ * ssd1306_scene_render() recomposites only the damaged areas, from a black
+ * background up, and marks only them dirty. Work and bus traffic follow
+ * what moves, not the size of the panel.
+ */
+
+typedef struct ssd1306_scene ssd1306_scene_t;
+typedef struct ssd1306_sprite ssd1306_sprite_t;
+
+// How a sprite combines with what is below it, within its bounds.
+#define SSD1306_BLEND_COPY 0   // Replace: the sprite is opaque.
+#define SSD1306_BLEND_OR   1   // Set bits turn pixels on.
+#define SSD1306_BLEND_AND  2   // Clear bits turn pixels off.
+#define SSD1306_BLEND_XOR  3   // Set bits toggle pixels.
+
+// Create an empty scene on disp. The whole panel is painted by the first
+// render. Returns NULL on failure.
+ssd1306_scene_t *ssd1306_scene_create(ssd1306_t *disp);
 
+// Free the scene and its sprites. The framebuffer keeps what was rendered.
+void ssd1306_scene_destroy(ssd1306_scene_t *scene);
+
+// Recomposite the damaged areas into the framebuffer and mark them dirty;
+// flush afterwards. Returns the number of page spans rewritten.
+int ssd1306_scene_render(ssd1306_scene_t *scene);
+
+// Add a w x h sprite at (0, 0). The bitmap is not copied and must outlive
+// the sprite. A NULL bitmap makes a layer: the sprite gets its own cleared
+// bitmap, to draw into through ssd1306_sprite_buffer(). Higher z is on top;
+// among sprites of equal z, the newest is.
+// Returns NULL on failure.
+ssd1306_sprite_t *ssd1306_sprite_create(ssd1306_scene_t *scene, const uint8_t *bitmap, int w, int h,
+                                        int z, int blend);
+
+// Remove a sprite from its scene and free it.
+void ssd1306_sprite_destroy(ssd1306_sprite_t *s);
+
+// Move the top-left corner of a sprite to (x, y); it may lie off the panel.
+void ssd1306_sprite_move(ssd1306_sprite_t *s, int x, int y);
+
+// Show another bitmap (or the same one, redrawn). Not for layers.
+void ssd1306_sprite_set_bitmap(ssd1306_sprite_t *s, const uint8_t *bitmap, int w, int h);
+
+// Restack a sprite at z, above the sprites already there.
+void ssd1306_sprite_set_z(ssd1306_sprite_t *s, int z);
+void ssd1306_sprite_set_blend(ssd1306_sprite_t *s, int blend);
+void ssd1306_sprite_set_visible(ssd1306_sprite_t *s, int visible);
+
+// The bitmap of a layer, or NULL for sprites created with a bitmap.
+uint8_t *ssd1306_sprite_buffer(ssd1306_sprite_t *s);
+
+// Mark a rectangle of a sprite, in sprite coordinates, as redrawn: after
+// drawing into a layer, or changing the pixels of a sprite's bitmap.
+void ssd1306_sprite_damage(ssd1306_sprite_t *s, int x, int y, int w, int h);
+
+/*
+ * Widgets
+ *
+ * Retained dashboard widgets: labels, numeric readouts, bar gauges and
+ * sparklines. Setting a value only records it; ssd1306_ui_render() redraws
+ * the widgets whose value changed, and within them only what changed: the
+ * characters of a label from the first difference on, the cells of a
+ * readout whose digit changed, the stretch between a bar's old and new
+ * length, the new samples of a sweeping sparkline. Widgets own their
+ * rectangle and draw its background, so stale pixels never linger.
+ */
+
+typedef struct ssd1306_ui ssd1306_ui_t;
+typedef struct ssd1306_widget ssd1306_widget_t;
+
+// Create an empty widget set on disp. Returns NULL on failure.
+ssd1306_ui_t *ssd1306_ui_create(ssd1306_t *disp);
+
+// Free the set and all its widgets. The framebuffer is left as it is.
+void ssd1306_ui_destroy(ssd1306_ui_t *ui);
+
+// Redraw the widgets that changed or were invalidated since the last call,
+// marking only the columns they touch dirty. Flush afterwards to send the
+// changes. Returns the number of widgets redrawn.
+int ssd1306_ui_render(ssd1306_ui_t *ui);
+
+// Remove a widget and clear its rectangle.
+void ssd1306_widget_destroy(ssd1306_widget_t *wd);
+
+// Repaint a widget in full at the next render, e.g. after drawing over it.
+void ssd1306_widget_invalidate(ssd1306_widget_t *wd);
+
+// A line of text up to w columns wide, in font (NULL: the built-in 5x8
+// font), with its top-left corner at (x, y). Text that does not fit is cut
+// at a character boundary.
+ssd1306_widget_t *ssd1306_label_create(ssd1306_ui_t *ui, int x, int y, int w, const ssd1306_font_t *font);
+void ssd1306_label_set(ssd1306_widget_t *wd, const char *text);
+
+// A number right-aligned in `cells` fixed-width character cells, with
+// `decimals` digits after the point: 1234 with 1 decimal reads 123.4.
+// Values too wide for the cells read as dashes.
+ssd1306_widget_t *ssd1306_readout_create(ssd1306_ui_t *ui, int x, int y, int cells, int decimals,
+                                         const ssd1306_font_t *font);
+void ssd1306_readout_set(ssd1306_widget_t *wd, long value);
+
+// A w x h bar filled in proportion to a value in min..max (clamped). Wide
+// bars grow to the right, tall ones upwards.
+ssd1306_widget_t *ssd1306_bar_create(ssd1306_ui_t *ui, int x, int y, int w, int h, int min, int max);
+void ssd1306_bar_set(ssd1306_widget_t *wd, int value);
+
+// Options of ssd1306_sparkline_create().
+#define SSD1306_SPARK_SWEEP 0x1   // Draw new samples in place, wrapping around, instead of scrolling.
+
+// A w x h line graph of the last w samples, one column each, scaled to
+// min..max (clamped). By default the graph scrolls left as samples come
+// in, which repaints every column; with SSD1306_SPARK_SWEEP each sample is
+// drawn where it lands, like an oscilloscope trace, and costs a column or
+// two on the bus.
+ssd1306_widget_t *ssd1306_sparkline_create(ssd1306_ui_t *ui, int x, int y, int w, int h, int min, int max,
+                                           int flags);
+void ssd1306_sparkline_push(ssd1306_widget_t *wd, int value);
+
+/*
+ * Virtual canvas
+ *
+ * A canvas larger than the panel, such as a 1024x64 ticker or a 128x512
+ * menu, shown through a viewport that pans by whole pixels. A pan computes
+ * only the columns or rows it brings into view: sideways pans move the
+ * framebuffer and, on controllers with content scroll, panel RAM too;
+ * vertical pans on 64-row panels rotate the start line. Bus traffic per
+ * frame follows the pan distance, not the canvas size. The canvas owns the
+ * framebuffer and start line while it is shown.
+ */
+
+typedef struct ssd1306_canvas ssd1306_canvas_t;
+
+// Produce n columns of canvas page page (rows page*8 to page*8+7), starting
+// at column x, into cols. Called only for columns the viewport brings in.
+typedef void (*ssd1306_canvas_fn)(void *arg, int page, int x, uint8_t *cols, int n);
+
+// Create a w x h canvas on disp with the viewport at (0, 0). With fn, the
+// content is streamed from it on demand; without, the canvas gets its own
+// cleared page-major bitmap to draw into. Returns NULL on failure.
+ssd1306_canvas_t *ssd1306_canvas_create(ssd1306_t *disp, int w, int h, ssd1306_canvas_fn fn, void *arg);
+
+// Free the canvas. The framebuffer keeps what was rendered.
+void ssd1306_canvas_destroy(ssd1306_canvas_t *c);
+
+// The bitmap of a canvas created without fn ((h + 7) / 8 pages of w
+// columns), or NULL.
+uint8_t *ssd1306_canvas_buffer(ssd1306_canvas_t *c);
+
+// Mark a rectangle of the canvas as redrawn, after changing its bitmap or
+// what fn produces for it.
+void ssd1306_canvas_damage(ssd1306_canvas_t *c, int x, int y, int w, int h);
+
+// Draw a string into the canvas bitmap with its top-left corner at (x, y)
+// and mark it damaged. Returns the column just past the text.
+int ssd1306_canvas_draw_text(ssd1306_canvas_t *c, const ssd1306_font_t *font, int x, int y, const char *str);
+
+// Fill a rectangle of the canvas bitmap and mark it damaged.
+void ssd1306_canvas_fill_rect(ssd1306_canvas_t *c, int x, int y, int w, int h, int color);
+
+// Move the viewport's top-left corner to canvas pixel (x, y), clamped so
+// the viewport stays on the canvas.
+void ssd1306_canvas_pan(ssd1306_canvas_t *c, int x, int y);
+void ssd1306_canvas_get_pan(const ssd1306_canvas_t *c, int *x, int *y);
+
+// Bring the framebuffer to the viewport: paint what the pan exposed and
+// what was damaged, and mark it dirty; flush afterwards. The first render
+// paints the whole panel. Returns the number of framebuffer bytes painted.
+int ssd1306_canvas_render(ssd1306_canvas_t *c);
+
+/*
+ * Console
+ *
+ * A scrolling text terminal in the built-in 5x8 font, 21 characters by 8
+ * lines. The 8 pages of panel RAM form a ring: a new line is written over
+ * the oldest one and the display start line is moved so that it shows up
+ * at the bottom. Scrolling a line costs one command plus the columns of
+ * the line that changed, instead of a whole frame. Panels shorter than 64
+ * rows show only part of the ring, so there the console moves the text up
+ * in the framebuffer instead.
+ */
+
+// Clear the display and put the console cursor at the top-left corner.
+void ssd1306_console_init(ssd1306_t *disp);
+
+// Append text at the console cursor. '\n' starts a new line, '\r' returns
+// to the start of the current one and long lines wrap. Changes reach the
+// panel with the next ssd1306_flush(), except for smooth scrolling, which
+// flushes each step itself. Returns 0 on success, -1 if a flush failed.
+int ssd1306_console_write(ssd1306_t *disp, const char *str);
+
+// Scroll one pixel row at a time, step_us microseconds apart, instead of
+// a whole line at once. 0 turns smooth scrolling off.
+void ssd1306_console_set_smooth(ssd1306_t *disp, unsigned step_us);
+
+// Show panel RAM row `line` (0-63) at the top of the screen. The view
+// wraps around, and the change is sent with the next ssd1306_flush().
+// Drawing coordinates keep addressing RAM rows.
+void ssd1306_set_start_line(ssd1306_t *disp, uint8_t line);
+
+// The start line set by the application.
+uint8_t ssd1306_get_start_line(const ssd1306_t *disp);
+
+/*
+ * Asynchronous flushing
+ *
+ * In async mode a worker thread owns the bus. ssd1306_flush() copies the
+ * framebuffer into a free slot, publishes it and returns without waiting.
+ * When frames come faster than the bus can send them, the worker always
+ * sends the newest one and drops the rest.
+ */
+
+// Start the flush worker. Returns 0 on success, -1 on error.
+int ssd1306_async_start(ssd1306_t *disp);
+
+// Send the last published frame, then stop the worker. Called by ssd1306_close().
+void ssd1306_async_stop(ssd1306_t *disp);
+
+// Number of published frames that were replaced before the worker sent them.
+unsigned long ssd1306_async_dropped(const ssd1306_t *disp);
+
+/*
+ * Frame pacing
+ *
+ * A pacer calls the application once per refresh slot, just before the
+ * slot, with the slot's time, and flushes what it drew. Drawing done
+ * between slots goes out in that one update. The pacer times the callback
+ * to wake it up no earlier than needed, and watches the bus time frames
+ * take (ssd1306_get_stats()): when the bus cannot keep up with the target
+ * rate, slots are spread out to the next rate it can sustain instead of
+ * queueing frames that are stale by the time they are sent.
+ */
+
+typedef struct ssd1306_pacer ssd1306_pacer_t;
+
+// Draw the frame shown at slot_ns (CLOCK_MONOTONIC nanoseconds). Return 0
+// to continue, anything else to stop the pacer after this frame.
+typedef int (*ssd1306_frame_fn)(ssd1306_t *disp, uint64_t slot_ns, void *arg);
+
+typedef struct {
+    unsigned hz;               // Current rate: the target, or lower while the bus is saturated.
+    unsigned sustainable_hz;   // Frames per second the bus could carry at the recent frame cost; 0 if unknown.
+    uint64_t frame_bus_ns;     // Average bus time of a frame update.
+    uint64_t render_ns;        // Average callback time.
+    uint64_t slots;            // Callbacks made.
+    uint64_t missed;           // Callbacks that finished after their slot.
+} ssd1306_pace_info_t;
+
+// Create a pacer for disp targeting hz frames per second. Returns NULL on failure.
+ssd1306_pacer_t *ssd1306_pacer_create(ssd1306_t *disp, unsigned hz);
+
+// Call render once per slot until it returns nonzero or ssd1306_pacer_stop()
+// is called. Returns render's nonzero result, or 0 when stopped.
+int ssd1306_pacer_run(ssd1306_pacer_t *p, ssd1306_frame_fn render, void *arg);
+
+// Make ssd1306_pacer_run() return before the next slot. Safe to call from
+// the callback, another thread or a signal handler.
+void ssd1306_pacer_stop(ssd1306_pacer_t *p);
+
+// Current rate and measurements. Call from the callback or after run returns.
+void ssd1306_pacer_info(const ssd1306_pacer_t *p, ssd1306_pace_info_t *info);
+
+// Free the pacer. The display stays open.
+void ssd1306_pacer_destroy(ssd1306_pacer_t *p);
+
+/*
+ * Statistics and tracing
+ *
+ * Every display counts what it sends and how long it takes. Comparing the
+ * counters tells a slow panel's causes apart: long waits for the bus lock
+ * (contention), retries and errors (a flaky bus), or few flushes at normal
+ * latency (the renderer).
+ */
+
+typedef struct {
+    uint64_t flushes;          // ssd1306_flush() calls.
+    uint64_t frames;           // Frame updates that reached the panel.
+    uint64_t frames_dropped;   // Frames replaced before the async worker sent them.
+    uint64_t xfers;            // Transfers, command transfers included.
+    uint64_t segs;             // Command and data segments in them.
+    uint64_t bytes;            // Payload bytes in them.
+    uint64_t errors;           // Transfers that failed.
+    uint64_t short_writes;     // Writes the bus took only part of.
+    uint64_t retries;          // Batches the transport resent.
+    uint64_t bus_ns;           // Time spent inside the transport.
+    uint64_t wait_ns;          // Time spent waiting for another thread's transfer.
+    uint32_t latency_p50_us;   // Frame update latency (encoding and transfer):
+    uint32_t latency_p99_us;   // percentiles accurate to within 25%,
+    uint32_t latency_max_us;   // and the slowest update.
+} ssd1306_stats_t;
+
+// Snapshot the counters collected since the display was opened or last reset.
+void ssd1306_get_stats(ssd1306_t *disp, ssd1306_stats_t *stats);
+
+// Zero the counters and the latency histogram.
+void ssd1306_reset_stats(ssd1306_t *disp);
+
+// Write a timestamped event for every transfer, frame update, flush and
+// dropped frame to path, in Chrome trace JSON (chrome://tracing, Perfetto).
+// Returns 0 on success, -1 on error.
+int ssd1306_trace_start(ssd1306_t *disp, const char *path);
+
+// Finish and close the trace file. Called by ssd1306_close().
+void ssd1306_trace_stop(ssd1306_t *disp);
+
+/*
+ * Multi-display manager
+ *
+ * Drives many displays across several buses. Each physical bus gets one
+ * worker thread: displays on different buses transfer in parallel, and
+ * displays sharing a bus take turns in the order their flushes were queued.
+ */
+
+typedef struct ssd1306_mgr ssd1306_mgr_t;
+
+// Create an empty manager. Returns NULL on failure.
+ssd1306_mgr_t *ssd1306_mgr_create(void);
+
+// Register a display. The manager does not take ownership of it.
+// Returns 0 on success, -1 on error.
+int ssd1306_mgr_add(ssd1306_mgr_t *mgr, ssd1306_t *disp);
+
+// Flush a group of registered displays (all of them when displays is NULL)
+// and wait until every one is done. Returns 0 if all succeeded, -1 otherwise.
+int ssd1306_mgr_flush(ssd1306_mgr_t *mgr, ssd1306_t *const *displays, size_t count);
+
+// Stop the bus workers and free the manager. Displays stay open.
+void ssd1306_mgr_destroy(ssd1306_mgr_t *mgr);
+
+/*
+ * Display server
+ *
+ * Lets several processes share one panel. The server owns the bus; each
+ * client draws into a display handle whose framebuffer is published to a
+ * memfd layer shared with the server, and ssd1306_flush() only signals the
+ * server over a Unix socket. Once per refresh tick the server composites
+ * the layers that changed, lowest z first, and sends the result in one
+ * diffed flush. Clients make no bus system calls.
+ */
+
+typedef struct ssd1306_server ssd1306_server_t;
+
+// Serve disp on a Unix socket at path, refreshing at most hz times a
+// second (0: 30). The server does not take ownership of disp.
+// Returns NULL on failure.
+ssd1306_server_t *ssd1306_server_create(ssd1306_t *disp, const char *path, unsigned hz);
+
+// Serve clients until ssd1306_server_stop(). Returns 0 when stopped, -1 on error.
+int ssd1306_server_run(ssd1306_server_t *srv);
+
+// Make ssd1306_server_run() return. Safe to call from a signal handler.
+void ssd1306_server_stop(ssd1306_server_t *srv);
+
+// Disconnect all clients, remove the socket and free the server.
+void ssd1306_server_destroy(ssd1306_server_t *srv);
+
+// Connect to the server at path with a layer at depth z (higher is on
+// top). The display takes the server panel's geometry and starts out
+// transparent. Returns NULL on failure.
+ssd1306_t *ssd1306_init_client(const char *path, int z);
+
+// Limit a client's layer to a rectangle, so the layers below show around
+// it. Takes effect with the next flush. By default a layer covers the
+// whole panel. Ignored for displays that are not clients.
+void ssd1306_client_set_region(ssd1306_t *disp, int x, int y, int w, int h);
+
+/*
+ * Command buffer
+ *
+ * Collects command bytes and sends them as one bus transaction behind a
+ * single 0x00 control byte, instead of one transaction per command byte.
+ */
+
+#define SSD1306_CMDBUF_SIZE 64
+
+typedef struct {
+    uint8_t buf[SSD1306_CMDBUF_SIZE];
+    size_t len;                           // Number of queued command bytes.
+    int overflow;                         // Set when a byte did not fit.
+} ssd1306_cmdbuf_t;
+
+// Reset a command buffer to empty.
+void ssd1306_cmdbuf_init(ssd1306_cmdbuf_t *cb);
+
+// Queue one command byte. Returns -1 if the buffer is full.
+int ssd1306_cmdbuf_add(ssd1306_cmdbuf_t *cb, uint8_t cmd);
+
+// Queue n command bytes. Returns -1 (and queues nothing) if they do not fit.
+int ssd1306_cmdbuf_add_n(ssd1306_cmdbuf_t *cb, const uint8_t *cmds, size_t n);
+
+// Send all queued bytes as one transaction and reset the buffer.
+// Returns 0 on success, -1 on error or if the buffer overflowed.
+int ssd1306_cmdbuf_send(ssd1306_t *disp, ssd1306_cmdbuf_t *cb);
+
+/*
+ * Scrolling
+ *
+ * The controller can scroll on its own, at no bus cost per step. A scroll
+ * is part of the display state like the start line: ssd1306_set_scroll()
+ * takes effect with the next ssd1306_flush(), which stops the running
+ * scroll, writes the frame and starts the new scroll in one transfer.
+ * A horizontal scroll rotates panel RAM, so the pages it covers are not
+ * updated while it runs; they are rewritten from the framebuffer when it
+ * stops.
+ */
+
+// Horizontal scroll directions.
+#define SSD1306_SCROLL_OFF   0
+#define SSD1306_SCROLL_RIGHT 1
+#define SSD1306_SCROLL_LEFT  2
+
+typedef struct {
+    uint8_t mode;                  // SSD1306_SCROLL_OFF, _RIGHT or _LEFT.
+    uint8_t vertical;              // Rows moved up per step (0-63). Non-zero uses the
+                                   // vertical and horizontal scroll commands (0x29/0x2A).
+    uint8_t start_page, end_page;  // Pages that scroll horizontally.
+    uint8_t start_col, end_col;    // Columns that scroll horizontally (horizontal-only
+                                   // scrolls; older controllers always use all 128).
+    uint16_t frames;               // Panel frames per step: 2, 3, 4, 5, 25, 64, 128 or
+                                   // 256. Other values round to the nearest.
+    uint8_t area_top, area_rows;   // Vertical scroll area (0xA3): fixed rows at the top,
+                                   // then rows that scroll. 0 rows means the whole panel.
+} ssd1306_scroll_t;
+
+// Set the hardware scroll, or stop it when scroll is NULL or has neither a
+// direction nor a vertical offset. Sent with the next ssd1306_flush().
+void ssd1306_set_scroll(ssd1306_t *disp, const ssd1306_scroll_t *scroll);
+
+// The scroll set by the application, normalized (all zero when off).
+void ssd1306_get_scroll(const ssd1306_t *disp, ssd1306_scroll_t *scroll);
+
+// Rotate a region of the framebuffer by cols columns (positive: right),
+// the software counterpart of a horizontal hardware scroll step.
+void ssd1306_rotate_region(ssd1306_t *disp, uint8_t start_page, uint8_t end_page,
+                           uint8_t start_col, uint8_t end_col, int cols);
+
+// How to scroll a marquee or ticker: by the controller or by redrawing.
+typedef struct {
+    int hardware;       // 1: let the controller scroll, 0: redraw in software.
+    uint16_t frames;    // Hardware interval nearest to the wanted speed.
+    size_t hw_bytes;    // Modeled bus bytes of each option over the run.
+    size_t sw_bytes;
+} ssd1306_scroll_plan_t;
+
+// Compare the bus cost of scrolling the pages and columns of region at
+// cols_per_sec for duration_ms (0: per second) in hardware and in software.
+// content_cols is the width of what scrolls: content wider than the region
+// needs new columns drawn at every step, which the controller cannot do.
+void ssd1306_scroll_plan(const ssd1306_scroll_t *region, unsigned content_cols,
+                         unsigned cols_per_sec, unsigned duration_ms, ssd1306_scroll_plan_t *plan);
+
+// Start a full-width horizontal scroll and flush. scroll_speed is the raw
+// 3-bit interval code of the controller (0 = 5 frames, 7 = 2 frames).
+void ssd1306_start_scroll_left(ssd1306_t *disp, uint8_t start_page, uint8_t end_page, uint8_t scroll_speed);
+void ssd1306_start_scroll_right(ssd1306_t *disp, uint8_t start_page, uint8_t end_page, uint8_t scroll_speed);
+
+// Stop any hardware scroll and flush, repainting the pages it moved.
+void ssd1306_stop_scroll(ssd1306_t *disp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SSD1306_H
@@ -0,0 +1,160 @@
+#ifndef SSD1306_HPP
+#define SSD1306_HPP
+
+// Header-only C++17 layer over the C library, specialized on panel
+// geometry at compile time. A Display<Panel128x32> keeps a 512-byte
+// framebuffer, and every loop over it has constant bounds.
+//
+//     oled::Display<oled::Panel72x40> panel(ssd1306_init("/dev/i2c-1", 0x3C));
+//     if (!panel) return 1;
+//     panel.fill_rect(0, 0, 10, 10, true);
+//     panel.flush();
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "ssd1306.h"
+
+namespace oled {
+
+// A panel geometry. ColOffset is the controller column of the leftmost
+// visible one; ComPins is the 0xDA setting the module is wired for.
+template <uint8_t W, uint8_t H, uint8_t ColOffset = 0, uint8_t ComPins = 0x12>
+struct Geometry {
+    static_assert(W > 0 && W + ColOffset <= SSD1306_WIDTH, "panel wider than controller RAM");
+    static_assert(H >= 16 && H <= SSD1306_HEIGHT && H % 8 == 0, "height must be 16-64 rows, in whole pages");
+
+    static constexpr uint8_t width = W;
+    static constexpr uint8_t height = H;
+    static constexpr uint8_t pages = H / 8;
+    static constexpr uint8_t col_offset = ColOffset;
+    static constexpr uint8_t com_pins = ComPins;
+    static constexpr std::size_t frame_bytes = std::size_t(W) * pages;
+
+    static constexpr ssd1306_geometry_t spec = { W, H, ColOffset, ComPins };
+};
+
+using Panel128x64 = Geometry<128, 64>;
+using Panel128x32 = Geometry<128, 32, 0, 0x02>;
+using Panel72x40 = Geometry<72, 40, 28>;
+using Panel64x48 = Geometry<64, 48, 32>;
+
+// A display of geometry G. Owns the C handle and closes it on destruction.
+// Draw into the display's own framebuffer here, or through handle() with
+// the C functions, but not both: flush() copies this framebuffer over the
+// C one.
+template <class G>
+class Display {
+public:
+    using geometry = G;
+    using frame_type = std::array<uint8_t, G::frame_bytes>;
+
+    // Take over an open display (which may be NULL) and configure it for G.
+    // A display warm-attached for G keeps what its panel shows.
+    explicit Display(ssd1306_t *disp) : disp_(disp) {
+        if (!disp_) {
+            return;
+        }
+        ssd1306_geometry_t geom;
+        ssd1306_get_geometry(disp_, &geom);
+        if (ssd1306_is_warm(disp_) && geom.width == G::width && geom.height == G::height &&
+            geom.col_offset == G::spec.col_offset && geom.com_pins == G::spec.com_pins) {
+            const uint8_t *src = ssd1306_get_buffer(disp_);
+            for (uint8_t page = 0; page < G::pages; page++) {
+                std::memcpy(&fb_[std::size_t(page) * G::width], src + std::size_t(page) * SSD1306_WIDTH, G::width);
+            }
+        } else if (ssd1306_set_geometry(disp_, &G::spec) < 0) {
+            ssd1306_close(disp_);
+            disp_ = nullptr;
+        }
+    }
+    ~Display() { ssd1306_close(disp_); }
+
+    Display(const Display &) = delete;
+    Display &operator=(const Display &) = delete;
+    Display(Display &&other) noexcept : disp_(other.disp_), fb_(other.fb_) { other.disp_ = nullptr; }
+    Display &operator=(Display &&other) noexcept {
+        if (this != &other) {
+            ssd1306_close(disp_);
+            disp_ = other.disp_;
+            fb_ = other.fb_;
+            other.disp_ = nullptr;
+        }
+        return *this;
+    }
+
+    explicit operator bool() const { return disp_ != nullptr; }
+    ssd1306_t *handle() const { return disp_; }
+
+    static constexpr int width() { return G::width; }
+    static constexpr int height() { return G::height; }
+
+    // Page-major framebuffer: byte [page * width() + col], LSB on top.
+    frame_type &buffer() { return fb_; }
+    const frame_type &buffer() const { return fb_; }
+
+    void clear() { fb_.fill(0); }
+
+    void set_pixel(int x, int y, bool on) {
+        if (unsigned(x) >= G::width || unsigned(y) >= G::height) {
+            return;
+        }
+        uint8_t &byte = fb_[std::size_t(y / 8) * G::width + unsigned(x)];
+        uint8_t bit = uint8_t(1u << (y % 8));
+        byte = on ? uint8_t(byte | bit) : uint8_t(byte & ~bit);
+    }
+
+    void fill_rect(int x, int y, int w, int h, bool on) {
+        int x0 = x < 0 ? 0 : x, y0 = y < 0 ? 0 : y;
+        int x1 = x + w > G::width ? G::width : x + w;
+        int y1 = y + h > G::height ? G::height : y + h;
+        if (x0 >= x1 || y0 >= y1) {
+            return;
+        }
+        for (int page = y0 / 8; page <= (y1 - 1) / 8; page++) {
+            uint8_t bits = 0xFF;
+            if (page == y0 / 8) {
+                bits &= uint8_t(0xFF << (y0 % 8));
+            }
+            if (page == (y1 - 1) / 8) {
+                bits &= uint8_t(0xFF >> (7 - (y1 - 1) % 8));
+            }
+            uint8_t *row = &fb_[std::size_t(page) * G::width];
+            for (int c = x0; c < x1; c++) {
+                row[c] = on ? uint8_t(row[c] | bits) : uint8_t(row[c] & ~bits);
+            }
+        }
+    }
+
+    // Copy the pages that changed into the C framebuffer and flush them.
+    // Returns 0 on success, -1 on error.
+    int flush() {
+        uint8_t *dst = ssd1306_get_buffer(disp_);
+        for (uint8_t page = 0; page < G::pages; page++) {
+            const uint8_t *src = &fb_[std::size_t(page) * G::width];
+            uint8_t *row = dst + std::size_t(page) * SSD1306_WIDTH;
+            int lo = 0, hi = G::width - 1;
+            while (lo < G::width && src[lo] == row[lo]) {
+                lo++;
+            }
+            if (lo == G::width) {
+                continue;
+            }
+            while (src[hi] == row[hi]) {
+                hi--;
+            }
+            std::memcpy(row + lo, src + lo, std::size_t(hi - lo + 1));
+            ssd1306_mark_dirty(disp_, page, uint8_t(lo), uint8_t(hi));
+        }
+        return ssd1306_flush(disp_);
+    }
+
+private:
+    ssd1306_t *disp_;
+    frame_type fb_{};
+};
+
+} // namespace oled
+
+#endif // SSD1306_HPP
@@ -1,242 +1,397 @@
-#include "ssd1306.h"
+#include "ssd1306_internal.h"
 #include <stdio.h>
 #include <stdlib.h>
-#include <fcntl.h>
-#include <unistd.h>
-#include <linux/i2c-dev.h>
-#include <sys/ioctl.h>
 #include <string.h>
 
-// Private helper: send a command byte to the display.
-static int ssd1306_send_cmd(int fd, uint8_t cmd) {
-    uint8_t buf[2] = {0x00, cmd};  // 0x00 indicates command mode
-    if (write(fd, buf, 2) != 2) {
-        perror("ssd1306: Failed to write command");
+// Contrast set by the init sequence.
+#define SSD1306_DEFAULT_CONTRAST 0xCF
+
+// Initialization sequence for SSD1306 (commands from the datasheet). The
+// geometry commands follow it, then Display ON.
+static const uint8_t init_sequence[] = {
+    0xAE,       // Display OFF
+    0xD5, 0x80, // Set display clock divide ratio/oscillator frequency (suggested ratio)
+    0xD3, 0x00, // Set display offset: no offset
+    0x40,       // Set start line address
+    0x8D, 0x14, // Charge pump setting: enable charge pump
+    0x20, 0x00, // Memory addressing mode: horizontal addressing mode
+    0xA1,       // Set segment re-map (mirror horizontally)
+    0xC8,       // Set COM output scan direction (remapped mode)
+    0x81, SSD1306_DEFAULT_CONTRAST, // Set contrast control
+    0xD9, 0xF1, // Set pre-charge period
+    0xDB, 0x40, // Set VCOMH deselect level
+    0xA4,       // Entire display follows RAM content
+    0xA6,       // Normal display (not inverted)
+};
+
+const ssd1306_geometry_t ssd1306_128x64 = { .width = 128, .height = 64, .col_offset = 0, .com_pins = 0x12 };
+const ssd1306_geometry_t ssd1306_128x32 = { .width = 128, .height = 32, .col_offset = 0, .com_pins = 0x02 };
+const ssd1306_geometry_t ssd1306_72x40 = { .width = 72, .height = 40, .col_offset = 28, .com_pins = 0x12 };
+const ssd1306_geometry_t ssd1306_64x48 = { .width = 64, .height = 48, .col_offset = 32, .com_pins = 0x12 };
+
+// Private helper: the commands that fit the controller to a geometry.
+static void ssd1306_geometry_commands(ssd1306_cmdbuf_t *cb, const ssd1306_geometry_t *geom) {
+    uint8_t cmds[] = {
+        0xA8, (uint8_t)(geom->height - 1),                            // Set multiplex ratio: one row per COM line
+        0xDA, geom->com_pins,                                         // Set COM pins hardware configuration
+        0x21, geom->col_offset, (uint8_t)(geom->col_offset + geom->width - 1), // Column address window
+        0x22, 0x00, (uint8_t)(geom->height / 8 - 1),                  // Page address window
+    };
+    ssd1306_cmdbuf_add_n(cb, cmds, sizeof(cmds));
+}
+
+// Private helper: adopt a geometry with the full panel as address window.
+static void ssd1306_use_geometry(ssd1306_t *disp, const ssd1306_geometry_t *geom) {
+    disp->geom = *geom;
+    disp->pages = geom->height / 8;
+    disp->window[0] = 0;
+    disp->window[1] = geom->width - 1;
+    disp->window[2] = 0;
+    disp->window[3] = disp->pages - 1;
+}
+
+void ssd1306_cmdbuf_init(ssd1306_cmdbuf_t *cb) {
+    cb->len = 0;
+    cb->overflow = 0;
+}
+
+int ssd1306_cmdbuf_add(ssd1306_cmdbuf_t *cb, uint8_t cmd) {
+    if (cb->len >= SSD1306_CMDBUF_SIZE) {
+        cb->overflow = 1;
         return -1;
     }
+    cb->buf[cb->len++] = cmd;
     return 0;
 }
 
-int ssd1306_init(const char *i2c_dev, uint8_t address) {
-    int fd = open(i2c_dev, O_RDWR);
-    if (fd < 0) {
-        perror("ssd1306: Failed to open I2C device");
+int ssd1306_cmdbuf_add_n(ssd1306_cmdbuf_t *cb, const uint8_t *cmds, size_t n) {
+    if (n > SSD1306_CMDBUF_SIZE - cb->len) {
+        cb->overflow = 1;
         return -1;
     }
-    if (ioctl(fd, I2C_SLAVE, address) < 0) {
-        perror("ssd1306: Failed to acquire bus access");
-        close(fd);
-        return -1;
+    memcpy(&cb->buf[cb->len], cmds, n);
+    cb->len += n;
+    return 0;
+}
+
+int ssd1306_cmdbuf_send(ssd1306_t *disp, ssd1306_cmdbuf_t *cb) {
+    int ret = 0;
+    if (cb->overflow) {
+        fprintf(stderr, "ssd1306: Command buffer overflow\n");
+        ret = -1;
+    } else if (cb->len > 0) {
+        ssd1306_seg_t seg = { SSD1306_CTRL_CMD, cb->buf, cb->len };
+        ret = ssd1306_xfer(disp, &seg, 1);
     }
+    ssd1306_cmdbuf_init(cb);
+    return ret;
+}
 
-    // Initialization sequence for SSD1306 (commands from the datasheet)
-    ssd1306_send_cmd(fd, 0xAE); // Display OFF
-    ssd1306_send_cmd(fd, 0xD5); // Set display clock divide ratio/oscillator frequency
-    ssd1306_send_cmd(fd, 0x80); // Suggested ratio
-    ssd1306_send_cmd(fd, 0xA8); // Set multiplex ratio
-    ssd1306_send_cmd(fd, 0x3F); // 64MUX for 128x64 display
-    ssd1306_send_cmd(fd, 0xD3); // Set display offset
-    ssd1306_send_cmd(fd, 0x00); // No offset
-    ssd1306_send_cmd(fd, 0x40); // Set start line address
-    ssd1306_send_cmd(fd, 0x8D); // Charge pump setting
-    ssd1306_send_cmd(fd, 0x14); // Enable charge pump
-    ssd1306_send_cmd(fd, 0x20); // Memory addressing mode
-    ssd1306_send_cmd(fd, 0x00); // Horizontal addressing mode
-    ssd1306_send_cmd(fd, 0xA1); // Set segment re-map (mirror horizontally)
-    ssd1306_send_cmd(fd, 0xC8); // Set COM output scan direction (remapped mode)
-    ssd1306_send_cmd(fd, 0xDA); // Set COM pins hardware configuration
-    ssd1306_send_cmd(fd, 0x12);
-    ssd1306_send_cmd(fd, 0x81); // Set contrast control
-    ssd1306_send_cmd(fd, 0xCF);
-    ssd1306_send_cmd(fd, 0xD9); // Set pre-charge period
-    ssd1306_send_cmd(fd, 0xF1);
-    ssd1306_send_cmd(fd, 0xDB); // Set VCOMH deselect level
-    ssd1306_send_cmd(fd, 0x40);
-    ssd1306_send_cmd(fd, 0xA4); // Entire display follows RAM content
-    ssd1306_send_cmd(fd, 0xA6); // Normal display (not inverted)
-    ssd1306_send_cmd(fd, 0xAF); // Display ON
-
-    return fd;
-}
-
-void ssd1306_close(int fd) {
-    if (fd >= 0) {
-        close(fd);
-    }
-}
-
-void ssd1306_set_cursor(int fd, uint8_t page, uint8_t col) {
-    ssd1306_send_cmd(fd, 0xB0 | (page & 0x07));         // Set page address (0xB0 to 0xB7)
-    ssd1306_send_cmd(fd, 0x00 | (col & 0x0F));            // Set lower column start address
-    ssd1306_send_cmd(fd, 0x10 | ((col >> 4) & 0x0F));     // Set higher column start address
-}
-
-void ssd1306_clear_display(int fd) {
-    uint8_t zeros[129];
-    zeros[0] = 0x40; // Data mode indicator
-    memset(&zeros[1], 0x00, 128);
-    for (uint8_t page = 0; page < 8; page++) {
-        ssd1306_send_cmd(fd, 0xB0 + page); // Set page address
-        ssd1306_send_cmd(fd, 0x00);        // Set lower column address
-        ssd1306_send_cmd(fd, 0x10);        // Set higher column address
-        if (write(fd, zeros, sizeof(zeros)) != sizeof(zeros)) {
-            perror("ssd1306: Failed to clear page");
+ssd1306_t *ssd1306_alloc(const ssd1306_transport_ops_t *ops, void *ctx) {
+    ssd1306_t *disp = calloc(1, sizeof(*disp));
+    if (!disp) {
+        perror("ssd1306: Failed to allocate display");
+        if (ops->close) {
+            ops->close(ctx);
         }
+        return NULL;
     }
+    disp->ops = ops;
+    disp->ctx = ctx;
+    pthread_mutex_init(&disp->xfer_lock, NULL);
+    pthread_mutex_init(&disp->stats_lock, NULL);
+    ssd1306_use_geometry(disp, &ssd1306_128x64);
+    if (ops->cost) {
+        ops->cost(ctx, &disp->cost);
+    } else {
+        // I2C at 400 kHz: 9 clocks per byte, and about 20 per message for
+        // the start condition, address byte and control byte.
+        disp->cost = (ssd1306_cost_t){ .xfer_ns = 30000, .seg_ns = 50000, .byte_ns = 22500 };
+    }
+    memset(disp->dirty_lo, DIRTY_NONE, sizeof(disp->dirty_lo));
+    return disp;
 }
 
-// -------------------------------------------------
-// A simple 5x8 font for ASCII characters 32 to 126.
-// Each character is represented by 5 bytes.
-#define FONT_START 32
-#define FONT_END   126
-
-static const uint8_t font5x8[95][5] = {
-    /* Space (32) */  {0x00,0x00,0x00,0x00,0x00},
-    /* '!' (33)   */  {0x00,0x00,0x5F,0x00,0x00},
-    /* '"' (34)   */  {0x00,0x07,0x00,0x07,0x00},
-    /* '#' (35)   */  {0x14,0x7F,0x14,0x7F,0x14},
-    /* '$' (36)   */  {0x24,0x2A,0x7F,0x2A,0x12},
-    /* '%' (37)   */  {0x23,0x13,0x08,0x64,0x62},
-    /* '&' (38)   */  {0x36,0x49,0x55,0x22,0x50},
-    /* ''' (39)   */  {0x00,0x05,0x03,0x00,0x00},
-    /* '(' (40)   */  {0x00,0x1C,0x22,0x41,0x00},
-    /* ')' (41)   */  {0x00,0x41,0x22,0x1C,0x00},
-    /* '*' (42)   */  {0x14,0x08,0x3E,0x08,0x14},
-    /* '+' (43)   */  {0x08,0x08,0x3E,0x08,0x08},
-    /* ',' (44)   */  {0x00,0x50,0x30,0x00,0x00},
-    /* '-' (45)   */  {0x08,0x08,0x08,0x08,0x08},
-    /* '.' (46)   */  {0x00,0x60,0x60,0x00,0x00},
-    /* '/' (47)   */  {0x20,0x10,0x08,0x04,0x02},
-    /* '0' (48)   */  {0x3E,0x51,0x49,0x45,0x3E},
-    /* '1' (49)   */  {0x00,0x42,0x7F,0x40,0x00},
-    /* '2' (50)   */  {0x42,0x61,0x51,0x49,0x46},
-    /* '3' (51)   */  {0x21,0x41,0x45,0x4B,0x31},
-    /* '4' (52)   */  {0x18,0x14,0x12,0x7F,0x10},
-    /* '5' (53)   */  {0x27,0x45,0x45,0x45,0x39},
-    /* '6' (54)   */  {0x3C,0x4A,0x49,0x49,0x30},
-    /* '7' (55)   */  {0x01,0x71,0x09,0x05,0x03},
-    /* '8' (56)   */  {0x36,0x49,0x49,0x49,0x36},
-    /* '9' (57)   */  {0x06,0x49,0x49,0x29,0x1E},
-    /* ':' (58)   */  {0x00,0x36,0x36,0x00,0x00},
-    /* ';' (59)   */  {0x00,0x56,0x36,0x00,0x00},
-    /* '<' (60)   */  {0x08,0x14,0x22,0x41,0x00},
-    /* '=' (61)   */  {0x14,0x14,0x14,0x14,0x14},
-    /* '>' (62)   */  {0x00,0x41,0x22,0x14,0x08},
-    /* '?' (63)   */  {0x02,0x01,0x51,0x09,0x06},
-    /* '@' (64)   */  {0x32,0x49,0x79,0x41,0x3E},
-    /* 'A' (65)   */  {0x7E,0x11,0x11,0x11,0x7E},
-    /* 'B' (66)   */  {0x7F,0x49,0x49,0x49,0x36},
-    /* 'C' (67)   */  {0x3E,0x41,0x41,0x41,0x22},
-    /* 'D' (68)   */  {0x7F,0x41,0x41,0x22,0x1C},
-    /* 'E' (69)   */  {0x7F,0x49,0x49,0x49,0x41},
-    /* 'F' (70)   */  {0x7F,0x09,0x09,0x09,0x01},
-    /* 'G' (71)   */  {0x3E,0x41,0x49,0x49,0x7A},
-    /* 'H' (72)   */  {0x7F,0x08,0x08,0x08,0x7F},
-    /* 'I' (73)   */  {0x00,0x41,0x7F,0x41,0x00},
-    /* 'J' (74)   */  {0x20,0x40,0x41,0x3F,0x01},
-    /* 'K' (75)   */  {0x7F,0x08,0x14,0x22,0x41},
-    /* 'L' (76)   */  {0x7F,0x40,0x40,0x40,0x40},
-    /* 'M' (77)   */  {0x7F,0x02,0x04,0x02,0x7F},
-    /* 'N' (78)   */  {0x7F,0x04,0x08,0x10,0x7F},
-    /* 'O' (79)   */  {0x3E,0x41,0x41,0x41,0x3E},
-    /* 'P' (80)   */  {0x7F,0x09,0x09,0x09,0x06},
-    /* 'Q' (81)   */  {0x3E,0x41,0x51,0x21,0x5E},
-    /* 'R' (82)   */  {0x7F,0x09,0x19,0x29,0x46},
-    /* 'S' (83)   */  {0x46,0x49,0x49,0x49,0x31},
-    /* 'T' (84)   */  {0x01,0x01,0x7F,0x01,0x01},
-    /* 'U' (85)   */  {0x3F,0x40,0x40,0x40,0x3F},
-    /* 'V' (86)   */  {0x1F,0x20,0x40,0x20,0x1F},
-    /* 'W' (87)   */  {0x3F,0x40,0x38,0x40,0x3F},
-    /* 'X' (88)   */  {0x63,0x14,0x08,0x14,0x63},
-    /* 'Y' (89)   */  {0x07,0x08,0x70,0x08,0x07},
-    /* 'Z' (90)   */  {0x61,0x51,0x49,0x45,0x43},
-    /* '[' (91)   */  {0x00,0x7F,0x41,0x41,0x00},
-    /* '\' (92)   */  {0x02,0x04,0x08,0x10,0x20},
-    /* ']' (93)   */  {0x00,0x41,0x41,0x7F,0x00},
-    /* '^' (94)   */  {0x04,0x02,0x01,0x02,0x04},
-    /* '_' (95)   */  {0x40,0x40,0x40,0x40,0x40},
-    /* '`' (96)   */  {0x00,0x03,0x07,0x00,0x00},
-    /* 'a' (97)   */  {0x20,0x54,0x54,0x54,0x78},
-    /* 'b' (98)   */  {0x7F,0x48,0x44,0x44,0x38},
-    /* 'c' (99)   */  {0x38,0x44,0x44,0x44,0x20},
-    /* 'd' (100)  */  {0x38,0x44,0x44,0x48,0x7F},
-    /* 'e' (101)  */  {0x38,0x54,0x54,0x54,0x18},
-    /* 'f' (102)  */  {0x08,0x7E,0x09,0x01,0x02},
-    /* 'g' (103)  */  {0x0C,0x52,0x52,0x52,0x3E},
-    /* 'h' (104)  */  {0x7F,0x08,0x04,0x04,0x78},
-    /* 'i' (105)  */  {0x00,0x44,0x7D,0x40,0x00},
-    /* 'j' (106)  */  {0x20,0x40,0x44,0x3D,0x00},
-    /* 'k' (107)  */  {0x7F,0x10,0x28,0x44,0x00},
-    /* 'l' (108)  */  {0x00,0x41,0x7F,0x40,0x00},
-    /* 'm' (109)  */  {0x7C,0x04,0x18,0x04,0x78},
-    /* 'n' (110)  */  {0x7C,0x08,0x04,0x04,0x78},
-    /* 'o' (111)  */  {0x38,0x44,0x44,0x44,0x38},
-    /* 'p' (112)  */  {0x7C,0x14,0x14,0x14,0x08},
-    /* 'q' (113)  */  {0x08,0x14,0x14,0x18,0x7C},
-    /* 'r' (114)  */  {0x7C,0x08,0x04,0x04,0x08},
-    /* 's' (115)  */  {0x48,0x54,0x54,0x54,0x20},
-    /* 't' (116)  */  {0x04,0x3F,0x44,0x40,0x20},
-    /* 'u' (117)  */  {0x3C,0x40,0x40,0x20,0x7C},
-    /* 'v' (118)  */  {0x1C,0x20,0x40,0x20,0x1C},
-    /* 'w' (119)  */  {0x3C,0x40,0x30,0x40,0x3C},
-    /* 'x' (120)  */  {0x44,0x28,0x10,0x28,0x44},
-    /* 'y' (121)  */  {0x0C,0x50,0x50,0x50,0x3C},
-    /* 'z' (122)  */  {0x44,0x64,0x54,0x4C,0x44},
-    /* '{' (123)  */  {0x00,0x08,0x36,0x41,0x00},
-    /* '|' (124)  */  {0x00,0x00,0x7F,0x00,0x00},
-    /* '}' (125)  */  {0x00,0x41,0x36,0x08,0x00},
-    /* '~' (126)  */  {0x08,0x04,0x08,0x10,0x08}
-};
+int ssd1306_cold_init(ssd1306_t *disp) {
+    // The whole init sequence goes out as a single command transaction.
+    ssd1306_cmdbuf_t cb;
+    ssd1306_cmdbuf_init(&cb);
+    ssd1306_cmdbuf_add_n(&cb, init_sequence, sizeof(init_sequence));
+    ssd1306_geometry_commands(&cb, &disp->geom);
+    ssd1306_cmdbuf_add(&cb, 0xAF); // Display ON
+    if (ssd1306_cmdbuf_send(disp, &cb) < 0) {
+        return -1;
+    }
+
+    disp->view.contrast = SSD1306_DEFAULT_CONTRAST;
+    disp->panel_view.contrast = SSD1306_DEFAULT_CONTRAST;
+
+    // Panel RAM content is unknown after power-up: the first flush sends everything.
+    ssd1306_clear_display(disp);
+    return 0;
+}
 
-void ssd1306_draw_char(int fd, char c) {
-    if (c < FONT_START || c > FONT_END) {
-        c = ' '; // Replace unsupported characters with space
+ssd1306_t *ssd1306_init_transport(const ssd1306_transport_ops_t *ops, void *ctx) {
+    ssd1306_t *disp = ssd1306_alloc(ops, ctx);
+    if (disp && ssd1306_cold_init(disp) < 0) {
+        ssd1306_close(disp);
+        return NULL;
     }
-    uint8_t idx = c - FONT_START;
-    // Prepare a 6-byte array: 1 byte for data mode + 5 font bytes.
-    uint8_t data[6];
-    data[0] = 0x40; // Data mode indicator
-    for (int i = 0; i < 5; i++) {
-        data[i + 1] = font5x8[idx][i];
+    return disp;
+}
+
+void ssd1306_close(ssd1306_t *disp) {
+    if (!disp) {
+        return;
     }
-    // Write the 6 bytes (5 columns of the character + 1 blank column for spacing)
-    if (write(fd, data, 6) != 6) {
-        perror("ssd1306: Failed to draw character");
+    ssd1306_async_stop(disp);
+    ssd1306_trace_stop(disp);
+    if (disp->ops->close) {
+        disp->ops->close(disp->ctx);
     }
+    pthread_mutex_destroy(&disp->stats_lock);
+    pthread_mutex_destroy(&disp->xfer_lock);
+    free(disp);
 }
 
-void ssd1306_draw_string(int fd, const char *str) {
-    while (*str) {
-        ssd1306_draw_char(fd, *str++);
+int ssd1306_set_geometry(ssd1306_t *disp, const ssd1306_geometry_t *geom) {
+    if (geom->width == 0 || geom->col_offset + geom->width > SSD1306_WIDTH ||
+        geom->height < 16 || geom->height > SSD1306_HEIGHT || geom->height % 8 != 0) {
+        fprintf(stderr, "ssd1306: Unsupported geometry %ux%u+%u\n", geom->width, geom->height, geom->col_offset);
+        return -1;
     }
+    if (disp->async) {
+        fprintf(stderr, "ssd1306: Cannot change geometry while the flush worker runs\n");
+        return -1;
+    }
+    ssd1306_cmdbuf_t cb;
+    ssd1306_cmdbuf_init(&cb);
+    ssd1306_geometry_commands(&cb, geom);
+    if (ssd1306_cmdbuf_send(disp, &cb) < 0) {
+        return -1;
+    }
+    ssd1306_use_geometry(disp, geom);
+
+    // Columns have moved under the shadow: start over from a blank frame.
+    // A running scroll may cover pages the panel no longer has, so it stops.
+    memset(&disp->view.scroll, 0, sizeof(disp->view.scroll));
+    disp->shadow_valid = 0;
+    disp->page = 0;
+    disp->col = 0;
+    memset(disp->dirty_lo, DIRTY_NONE, sizeof(disp->dirty_lo));
+    memset(disp->dirty_hi, 0, sizeof(disp->dirty_hi));
+    ssd1306_clear_display(disp);
+    return 0;
+}
+
+void ssd1306_get_geometry(const ssd1306_t *disp, ssd1306_geometry_t *geom) {
+    *geom = disp->geom;
 }
 
-// Scrolling functions.
-void ssd1306_start_scroll_left(int fd, uint8_t start_page, uint8_t end_page, uint8_t scroll_speed) {
-    ssd1306_send_cmd(fd, 0x2E); // Deactivate scrolling.
-    ssd1306_send_cmd(fd, 0x27); // Left horizontal scroll command.
-    ssd1306_send_cmd(fd, 0x00); // Dummy byte.
-    ssd1306_send_cmd(fd, start_page); // Start page.
-    ssd1306_send_cmd(fd, scroll_speed); // Time interval.
-    ssd1306_send_cmd(fd, end_page);   // End page.
-    ssd1306_send_cmd(fd, 0x00); // Dummy byte.
-    ssd1306_send_cmd(fd, 0xFF); // Dummy byte.
-    ssd1306_send_cmd(fd, 0x2F); // Activate scroll.
+void ssd1306_set_cursor(ssd1306_t *disp, uint8_t page, uint8_t col) {
+    disp->page = page % disp->pages;
+    disp->col = col % disp->geom.width;
 }
 
-void ssd1306_start_scroll_right(int fd, uint8_t start_page, uint8_t end_page, uint8_t scroll_speed) {
-    ssd1306_send_cmd(fd, 0x2E); // Deactivate scrolling.
-    ssd1306_send_cmd(fd, 0x26); // Right horizontal scroll command.
-    ssd1306_send_cmd(fd, 0x00); // Dummy byte.
-    ssd1306_send_cmd(fd, start_page); // Start page.
-    ssd1306_send_cmd(fd, scroll_speed); // Time interval.
-    ssd1306_send_cmd(fd, end_page);   // End page.
-    ssd1306_send_cmd(fd, 0x00); // Dummy byte.
-    ssd1306_send_cmd(fd, 0xFF); // Dummy byte.
-    ssd1306_send_cmd(fd, 0x2F); // Activate scroll.
+void ssd1306_mark_dirty(ssd1306_t *disp, uint8_t page, uint8_t col_start, uint8_t col_end) {
+    if (page >= disp->pages || col_start > col_end || col_start >= disp->geom.width) {
+        return;
+    }
+    if (col_end >= disp->geom.width) {
+        col_end = disp->geom.width - 1;
+    }
+    if (disp->dirty_lo[page] == DIRTY_NONE || col_start < disp->dirty_lo[page]) {
+        disp->dirty_lo[page] = col_start;
+    }
+    if (col_end > disp->dirty_hi[page]) {
+        disp->dirty_hi[page] = col_end;
+    }
 }
 
-void ssd1306_stop_scroll(int fd) {
-    ssd1306_send_cmd(fd, 0x2E); // Deactivate scrolling.
+void ssd1306_clear_display(ssd1306_t *disp) {
+    memset(disp->fb, 0x00, sizeof(disp->fb));
+    for (uint8_t page = 0; page < disp->pages; page++) {
+        ssd1306_mark_dirty(disp, page, 0, disp->geom.width - 1);
+    }
+}
+
+void ssd1306_set_pixel(ssd1306_t *disp, int x, int y, int on) {
+    if (x < 0 || x >= disp->geom.width || y < 0 || y >= disp->geom.height) {
+        return;
+    }
+    uint8_t *byte = &disp->fb[y / 8][x];
+    uint8_t old = *byte;
+    if (on) {
+        *byte |= (uint8_t)(1 << (y % 8));
+    } else {
+        *byte &= (uint8_t)~(1 << (y % 8));
+    }
+    if (*byte != old) {
+        ssd1306_mark_dirty(disp, y / 8, x, x);
+    }
+}
+
+void ssd1306_set_start_line(ssd1306_t *disp, uint8_t line) {
+    disp->view.start_line = line & (SSD1306_HEIGHT - 1);
+}
+
+uint8_t ssd1306_get_start_line(const ssd1306_t *disp) {
+    return disp->view.start_line;
+}
+
+void ssd1306_set_contrast(ssd1306_t *disp, uint8_t contrast) {
+    disp->view.contrast = contrast;
+}
+
+uint8_t ssd1306_get_contrast(const ssd1306_t *disp) {
+    return disp->view.contrast;
+}
+
+void ssd1306_set_content_scroll(ssd1306_t *disp, int supported) {
+    disp->content_scroll = supported != 0;
+}
+
+void ssd1306_set_cost(ssd1306_t *disp, const ssd1306_cost_t *cost) {
+    disp->cost = *cost;
+}
+
+void ssd1306_get_flush_report(ssd1306_t *disp, ssd1306_flush_report_t *report) {
+    pthread_mutex_lock(&disp->stats_lock);
+    *report = disp->report;
+    pthread_mutex_unlock(&disp->stats_lock);
+}
+
+uint8_t *ssd1306_get_buffer(ssd1306_t *disp) {
+    return &disp->fb[0][0];
+}
+
+void ssd1306_set_max_transfer(ssd1306_t *disp, size_t bytes) {
+    if (disp->ops->set_max_transfer) {
+        disp->ops->set_max_transfer(disp->ctx, bytes);
+    }
+}
+
+int ssd1306_flush_frame(ssd1306_t *disp, const uint8_t *frame, const ssd1306_view_t *view,
+                        const uint8_t *dirty_lo, const uint8_t *dirty_hi) {
+    uint64_t t0 = ssd1306_now_ns();
+    ssd1306_enc_t enc;
+    ssd1306_cmdbuf_t post;
+
+    ssd1306_enc_init(&enc, disp->window);
+    ssd1306_cmdbuf_init(&post);
+
+    // A horizontal hardware scroll moves RAM around under the shadow. While
+    // it runs, its pages are left alone; once it stops they are rewritten
+    // in full. Changing scroll setup requires stopping the old scroll first.
+    const ssd1306_scroll_t *scroll = &disp->panel_view.scroll;
+    int rescroll = memcmp(&view->scroll, scroll, sizeof(*scroll)) != 0;
+    uint8_t frozen = 0, repaint = 0;
+    if (!rescroll) {
+        frozen = ssd1306_scroll_pages(scroll);
+    } else if (scroll->mode != SSD1306_SCROLL_OFF || scroll->vertical) {
+        static const uint8_t stop = 0x2E; // Deactivate scroll
+        ssd1306_enc_cmd(&enc, &stop, 1);
+        repaint = ssd1306_scroll_pages(scroll);
+    }
+
+    // Content that moved sideways by one column can be moved in panel RAM
+    // by a content scroll (0x2C/0x2D), so the shadow moves with it and only
+    // the exposed column is sent. The controller needs two frames between
+    // shifts; wider or closer moves are sent as data, and so is a frame
+    // that does not mark every column dirty.
+    int8_t shift = (int8_t)(view->hshift - disp->panel_view.hshift);
+    int shifted = 0, whole = 1;
+    for (uint8_t page = 0; page < disp->pages; page++) {
+        whole &= dirty_lo[page] == 0 && dirty_hi[page] == disp->geom.width - 1;
+    }
+    if ((shift == 1 || shift == -1) && disp->content_scroll && disp->shadow_valid && whole && !rescroll &&
+        scroll->mode == SSD1306_SCROLL_OFF && !scroll->vertical &&
+        t0 - disp->shift_ns >= 2000000000ULL / PANEL_FRAME_HZ) {
+        uint8_t x0 = disp->geom.col_offset, x1 = (uint8_t)(x0 + disp->geom.width - 1);
+        uint8_t cmds[] = { shift > 0 ? 0x2C : 0x2D, 0x00, 0x00, 0x01, disp->pages - 1, x0, x1 };
+        ssd1306_enc_cmd(&enc, cmds, sizeof(cmds));
+        size_t n = disp->geom.width - 1;
+        for (uint8_t page = 0; page < disp->pages; page++) {
+            uint8_t *row = disp->shadow[page];
+            // What shifts in at the edge is not known: make sure it is sent.
+            if (shift > 0) {
+                memmove(row + 1, row, n);
+                row[0] = (uint8_t)~frame[(size_t)page * SSD1306_WIDTH];
+            } else {
+                memmove(row, row + 1, n);
+                row[n] = (uint8_t)~frame[(size_t)page * SSD1306_WIDTH + n];
+            }
+        }
+        shifted = 1;
+    }
+
+    ssd1306_encode(disp, frame, dirty_lo, dirty_hi, frozen, repaint, &enc);
+
+    // The view changes only after the rows it brings in have been written.
+    // Stopping a vertical scroll does not undo the offset it reached, so
+    // the start line is sent again.
+    if (view->start_line != disp->panel_view.start_line || (rescroll && scroll->vertical)) {
+        ssd1306_cmdbuf_add(&post, 0x40 | view->start_line); // Set display start line
+    }
+    if (rescroll) {
+        ssd1306_scroll_commands(disp, &post, &view->scroll);
+    }
+    if (view->contrast != disp->panel_view.contrast) {
+        uint8_t cmds[] = { 0x81, view->contrast }; // Set contrast control
+        ssd1306_cmdbuf_add_n(&post, cmds, sizeof(cmds));
+    }
+    ssd1306_enc_cmd(&enc, post.buf, post.len);
+    enc.report.segs = enc.nsegs;
+
+    // Everything goes out in one transfer.
+    int ret = enc.nsegs > 0 ? ssd1306_xfer(disp, enc.segs, enc.nsegs) : 0;
+    ssd1306_stats_frame(disp, &enc.report, ret, t0);
+    if (ret < 0) {
+        // The panel may have run any prefix of the transfer: a new window,
+        // a shift, part of the data. Forget the window so the next frame
+        // sets it again, and send the dirty columns whole rather than
+        // diffed against a shadow that may no longer match RAM.
+        memset(disp->window, 0xFF, sizeof(disp->window));
+        disp->shadow_valid = 0;
+        return -1;
+    }
+    if (shifted) {
+        disp->shift_ns = t0;
+    }
+    // Only a transfer that rewrote every visible byte makes RAM known again
+    // after a failure.
+    if (!frozen && whole && (!disp->shadow_valid || enc.report.plan == SSD1306_PLAN_FULL)) {
+        pthread_mutex_lock(&disp->xfer_lock);
+        disp->ram_uncertain = 0;
+        pthread_mutex_unlock(&disp->xfer_lock);
+    }
+    disp->panel_view = *view;
+    memcpy(disp->window, enc.window, sizeof(disp->window));
+    for (uint8_t page = 0; page < disp->pages; page++) {
+        if (enc.lo[page] != DIRTY_NONE) {
+            memcpy(&disp->shadow[page][enc.lo[page]], frame + (size_t)page * SSD1306_WIDTH + enc.lo[page],
+                   enc.hi[page] - enc.lo[page] + 1);
+        }
+    }
+    disp->shadow_valid = 1;
+    return 0;
+}
+
+int ssd1306_flush(ssd1306_t *disp) {
+    int ret;
+    ssd1306_stats_event(disp, STATS_FLUSH);
+    if (disp->client) {
+        ret = ssd1306_client_present(disp);
+    } else if (disp->async) {
+        ret = ssd1306_async_present(disp);
+    } else {
+        ret = ssd1306_flush_frame(disp, &disp->fb[0][0], &disp->view,
+                                  disp->dirty_lo, disp->dirty_hi);
+    }
+    // On failure everything stays dirty so the next flush retries it.
+    if (ret == 0) {
+        memset(disp->dirty_lo, DIRTY_NONE, sizeof(disp->dirty_lo));
+        memset(disp->dirty_hi, 0, sizeof(disp->dirty_hi));
+    }
+    return ret;
 }
@@ -0,0 +1,139 @@
+#include "ssd1306_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+
+// Set in `latest` while the slot it names has not been picked up by the worker.
+#define SLOT_FRESH 0x4u
+#define SLOT_MASK  0x3u
+
+// How long the worker waits before retrying a frame that failed to send.
+#define RETRY_NS 10000000L
+
+// Three frame slots rotate between the application and the worker:
+// `back` is filled by ssd1306_flush(), `front` is being sent, and `latest`
+// holds the most recently published one. Handing a slot over is a single
+// atomic exchange, so neither side ever waits for the other.
+struct ssd1306_async {
+    pthread_t thread;
+    sem_t wake;
+    atomic_int stop;
+    atomic_uint latest;         // Slot index | SLOT_FRESH.
+    atomic_ulong dropped;       // Frames replaced before the worker sent them.
+    unsigned back;              // Owned by the application.
+    unsigned front;             // Owned by the worker.
+    uint8_t slots[3][SSD1306_PAGES * SSD1306_WIDTH];
+    ssd1306_view_t view[3];     // Controller state published with each slot.
+};
+
+static void *ssd1306_async_worker(void *arg) {
+    ssd1306_t *disp = arg;
+    struct ssd1306_async *as = disp->async;
+    uint8_t all_lo[SSD1306_PAGES], all_hi[SSD1306_PAGES];
+    int retry = 0;
+
+    // Frames are diffed against the shadow as a whole: dropped frames
+    // may have touched columns the newest one did not.
+    memset(all_lo, 0, sizeof(all_lo));
+    memset(all_hi, SSD1306_WIDTH - 1, sizeof(all_hi));
+
+    for (;;) {
+        if (retry) {
+            struct timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            ts.tv_nsec += RETRY_NS;
+            if (ts.tv_nsec >= 1000000000L) {
+                ts.tv_sec++;
+                ts.tv_nsec -= 1000000000L;
+            }
+            while (sem_timedwait(&as->wake, &ts) < 0 && errno == EINTR) {
+            }
+        } else {
+            while (sem_wait(&as->wake) < 0 && errno == EINTR) {
+            }
+        }
+
+        if (atomic_load(&as->latest) & SLOT_FRESH) {
+            // Take the newest frame and hand the old front slot back.
+            as->front = atomic_exchange(&as->latest, as->front) & SLOT_MASK;
+            retry = 1;
+        }
+        if (retry) {
+            retry = ssd1306_flush_frame(disp, as->slots[as->front], &as->view[as->front],
+                                        all_lo, all_hi) < 0;
+        }
+        if (atomic_load(&as->stop) && !(atomic_load(&as->latest) & SLOT_FRESH)) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+int ssd1306_async_start(ssd1306_t *disp) {
+    if (disp->async) {
+        return 0;
+    }
+    struct ssd1306_async *as = calloc(1, sizeof(*as));
+    if (!as) {
+        perror("ssd1306: Failed to allocate flush worker");
+        return -1;
+    }
+    if (sem_init(&as->wake, 0, 0) < 0) {
+        perror("ssd1306: Failed to create flush worker semaphore");
+        free(as);
+        return -1;
+    }
+    // Slot 0 is the back buffer, 1 the first front buffer, 2 starts as `latest`.
+    as->back = 0;
+    as->front = 1;
+    atomic_init(&as->latest, 2);
+    atomic_init(&as->stop, 0);
+    atomic_init(&as->dropped, 0);
+
+    disp->async = as;
+    int err = pthread_create(&as->thread, NULL, ssd1306_async_worker, disp);
+    if (err != 0) {
+        fprintf(stderr, "ssd1306: Failed to start flush worker: %s\n", strerror(err));
+        disp->async = NULL;
+        sem_destroy(&as->wake);
+        free(as);
+        return -1;
+    }
+    return 0;
+}
+
+void ssd1306_async_stop(ssd1306_t *disp) {
+    struct ssd1306_async *as = disp->async;
+    if (!as) {
+        return;
+    }
+    // The worker sends whatever was published last before it exits.
+    atomic_store(&as->stop, 1);
+    sem_post(&as->wake);
+    pthread_join(as->thread, NULL);
+    sem_destroy(&as->wake);
+    disp->async = NULL;
+    free(as);
+}
+
+int ssd1306_async_present(ssd1306_t *disp) {
+    struct ssd1306_async *as = disp->async;
+    memcpy(as->slots[as->back], disp->fb, sizeof(disp->fb));
+    as->view[as->back] = disp->view;
+    unsigned prev = atomic_exchange(&as->latest, as->back | SLOT_FRESH);
+    if (prev & SLOT_FRESH) {
+        atomic_fetch_add(&as->dropped, 1);
+        ssd1306_stats_event(disp, STATS_DROP);
+    }
+    as->back = prev & SLOT_MASK;
+    sem_post(&as->wake);
+    return 0;
+}
+
+unsigned long ssd1306_async_dropped(const ssd1306_t *disp) {
+    return disp->async ? atomic_load(&disp->async->dropped) : 0;
+}
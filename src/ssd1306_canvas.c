@@ -0,0 +1,283 @@
+#include "ssd1306_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Largest canvas side in pixels.
+#define CANVAS_MAX 32767
+
+// The panel shows a window of the canvas with its top-left corner at the
+// viewport origin. Horizontal pans move the framebuffer sideways and paint
+// only the exposed columns; the flush can then move panel RAM the same way
+// with a content scroll. On panels that show all 64 RAM rows, vertical
+// pans rotate the start line instead: RAM row r holds the canvas row y in
+// [vy, vy + 64) with y = r mod 64, so only rows coming into view are
+// painted. Shorter panels repaint on vertical pans.
+
+struct ssd1306_canvas {
+    ssd1306_t *disp;
+    int w, h, pages;
+    uint8_t *buf;              // Page-major, pages of w columns; NULL when streamed.
+    ssd1306_canvas_fn fn;      // Source of streamed canvases.
+    void *arg;
+    int ring;                  // Vertical pans rotate the start line.
+    int x, y;                  // Viewport origin.
+    int shown, shown_x, shown_y; // Origin the framebuffer holds, once shown.
+    int dx0, dy0, dx1, dy1;    // Damaged area in canvas pixels, x1/y1 exclusive. Empty when dx0 >= dx1.
+};
+
+ssd1306_canvas_t *ssd1306_canvas_create(ssd1306_t *disp, int w, int h, ssd1306_canvas_fn fn, void *arg) {
+    if (w <= 0 || h <= 0 || w > CANVAS_MAX || h > CANVAS_MAX) {
+        fprintf(stderr, "ssd1306: Unsupported canvas size %dx%d\n", w, h);
+        return NULL;
+    }
+    ssd1306_canvas_t *c = calloc(1, sizeof(*c));
+    if (!c) {
+        perror("ssd1306: Failed to allocate canvas");
+        return NULL;
+    }
+    c->disp = disp;
+    c->w = w;
+    c->h = h;
+    c->pages = (h + 7) / 8;
+    c->fn = fn;
+    c->arg = arg;
+    if (!fn) {
+        c->buf = calloc((size_t)c->pages, (size_t)w);
+        if (!c->buf) {
+            perror("ssd1306: Failed to allocate canvas");
+            free(c);
+            return NULL;
+        }
+    }
+    c->ring = disp->pages == SSD1306_PAGES;
+    return c;
+}
+
+void ssd1306_canvas_destroy(ssd1306_canvas_t *c) {
+    if (!c) {
+        return;
+    }
+    free(c->buf);
+    free(c);
+}
+
+uint8_t *ssd1306_canvas_buffer(ssd1306_canvas_t *c) {
+    return c->buf;
+}
+
+void ssd1306_canvas_damage(ssd1306_canvas_t *c, int x, int y, int w, int h) {
+    int x0 = x < 0 ? 0 : x, y0 = y < 0 ? 0 : y;
+    int x1 = x + w > c->w ? c->w : x + w, y1 = y + h > c->h ? c->h : y + h;
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+    if (c->dx0 >= c->dx1) {
+        c->dx0 = x0, c->dy0 = y0, c->dx1 = x1, c->dy1 = y1;
+        return;
+    }
+    c->dx0 = x0 < c->dx0 ? x0 : c->dx0;
+    c->dy0 = y0 < c->dy0 ? y0 : c->dy0;
+    c->dx1 = x1 > c->dx1 ? x1 : c->dx1;
+    c->dy1 = y1 > c->dy1 ? y1 : c->dy1;
+}
+
+// Private helper: write an 8-pixel-tall strip of n column bytes into the
+// canvas buffer at (x, y), clipped, like ssd1306_blit_strip().
+static void ssd1306_canvas_strip(ssd1306_canvas_t *c, int x, int y, const uint8_t *cols, int n) {
+    if (x < 0) {
+        cols += -x;
+        n += x;
+        x = 0;
+    }
+    if (n > c->w - x) {
+        n = c->w - x;
+    }
+    if (n <= 0) {
+        return;
+    }
+    int page = y >= 0 ? y / 8 : -((7 - y) / 8);
+    int shift = y - page * 8;
+    for (int half = 0; half < 2; half++, page++) {
+        if (page < 0 || page >= c->pages || (half && shift == 0)) {
+            continue;
+        }
+        uint8_t keep = half ? (uint8_t)(0xFF << shift) : (uint8_t)~(0xFF << shift);
+        uint8_t *row = c->buf + (size_t)page * c->w + x;
+        for (int i = 0; i < n; i++) {
+            uint8_t bits = half ? (uint8_t)(cols[i] >> (8 - shift)) : (uint8_t)(cols[i] << shift);
+            row[i] = (row[i] & keep) | bits;
+        }
+    }
+}
+
+int ssd1306_canvas_draw_text(ssd1306_canvas_t *c, const ssd1306_font_t *font, int x, int y, const char *str) {
+    int x0 = x, pages = font->height / 8;
+    if (!c->buf) {
+        return x + ssd1306_text_width(font, str);
+    }
+    for (; *str; str++) {
+        int idx = ssd1306_glyph_index(font, *str);
+        if (idx < 0) {
+            continue;
+        }
+        uint8_t width = font->widths[idx];
+        const uint8_t *glyph = font->bitmap + font->offsets[idx];
+        if (x < c->w && x + width > 0) {
+            for (int p = 0; p < pages; p++) {
+                ssd1306_canvas_strip(c, x, y + p * 8, glyph + p * width, width);
+            }
+        }
+        x += width;
+    }
+    ssd1306_canvas_damage(c, x0, y, x - x0, font->height);
+    return x;
+}
+
+void ssd1306_canvas_fill_rect(ssd1306_canvas_t *c, int x, int y, int w, int h, int color) {
+    int x0 = x < 0 ? 0 : x, y0 = y < 0 ? 0 : y;
+    int x1 = x + w > c->w ? c->w : x + w, y1 = y + h > c->h ? c->h : y + h;
+    if (!c->buf || x0 >= x1 || y0 >= y1) {
+        return;
+    }
+    for (int page = y0 / 8; page <= (y1 - 1) / 8; page++) {
+        int r0 = page * 8 > y0 ? 0 : y0 - page * 8;
+        int r1 = page * 8 + 8 < y1 ? 8 : y1 - page * 8;
+        uint8_t bits = (uint8_t)((0xFF << r0) & (0xFF >> (8 - r1)));
+        uint8_t *row = c->buf + (size_t)page * c->w;
+        for (int col = x0; col < x1; col++) {
+            row[col] = color ? (row[col] | bits) : (uint8_t)(row[col] & ~bits);
+        }
+    }
+    ssd1306_canvas_damage(c, x0, y0, x1 - x0, y1 - y0);
+}
+
+void ssd1306_canvas_pan(ssd1306_canvas_t *c, int x, int y) {
+    int max_x = c->w - c->disp->geom.width, max_y = c->h - c->disp->geom.height;
+    x = x > max_x ? max_x : x;
+    y = y > max_y ? max_y : y;
+    c->x = x < 0 ? 0 : x;
+    c->y = y < 0 ? 0 : y;
+}
+
+void ssd1306_canvas_get_pan(const ssd1306_canvas_t *c, int *x, int *y) {
+    *x = c->x;
+    *y = c->y;
+}
+
+// Private helper: n columns of a canvas page from column x, blank outside
+// the canvas.
+static void ssd1306_canvas_fetch(ssd1306_canvas_t *c, int page, int x, int n, uint8_t *out) {
+    memset(out, 0, (size_t)n);
+    int x0 = x < 0 ? 0 : x, x1 = x + n > c->w ? c->w : x + n;
+    if (page < 0 || page >= c->pages || x0 >= x1) {
+        return;
+    }
+    if (c->fn) {
+        c->fn(c->arg, page, x0, out + (x0 - x), x1 - x0);
+    } else {
+        memcpy(out + (x0 - x), c->buf + (size_t)page * c->w + x0, (size_t)(x1 - x0));
+    }
+    if (page == c->pages - 1 && c->h % 8) {
+        uint8_t bits = (uint8_t)(0xFF >> (8 - c->h % 8));
+        for (int i = x0 - x; i < x1 - x; i++) {
+            out[i] &= bits;
+        }
+    }
+}
+
+// Private helper: with the viewport at (ox, oy), repaint panel columns
+// sx0..sx1 of the rows that show canvas rows ya..yb-1. Returns the number
+// of framebuffer bytes written.
+static size_t ssd1306_canvas_paint(ssd1306_canvas_t *c, int ox, int oy, int sx0, int sx1, int ya, int yb) {
+    ssd1306_t *disp = c->disp;
+    uint8_t a[SSD1306_WIDTH], b[SSD1306_WIDTH];
+    int n = sx1 - sx0 + 1;
+    size_t painted = 0;
+
+    for (int page = 0; page < disp->pages; page++) {
+        // Bit k of the page shows canvas row top + k. In the ring the bits
+        // from seam on wrap to the top of the window, 64 rows earlier.
+        int top = c->ring ? oy + ((page * 8 - oy) & (SSD1306_HEIGHT - 1)) : oy + page * 8;
+        int seam = c->ring && top + 8 > oy + SSD1306_HEIGHT ? oy + SSD1306_HEIGHT - top : 8;
+        uint8_t mask = 0;
+        for (int k = 0; k < 8; k++) {
+            int y = k < seam ? top + k : top + k - SSD1306_HEIGHT;
+            if (y >= ya && y < yb) {
+                mask |= (uint8_t)(1 << k);
+            }
+        }
+        if (mask == 0) {
+            continue;
+        }
+
+        ssd1306_canvas_fetch(c, top / 8, ox + sx0, n, a);
+        if (seam < 8) {
+            uint8_t low = (uint8_t)((1 << seam) - 1);
+            ssd1306_canvas_fetch(c, top / 8 - SSD1306_PAGES, ox + sx0, n, b);
+            for (int i = 0; i < n; i++) {
+                a[i] = (uint8_t)((a[i] & low) | (b[i] & ~low));
+            }
+        } else if (top % 8) {
+            int shift = top % 8;
+            ssd1306_canvas_fetch(c, top / 8 + 1, ox + sx0, n, b);
+            for (int i = 0; i < n; i++) {
+                a[i] = (uint8_t)((a[i] >> shift) | (b[i] << (8 - shift)));
+            }
+        }
+        uint8_t *row = &disp->fb[page][sx0];
+        for (int i = 0; i < n; i++) {
+            row[i] = (uint8_t)((row[i] & ~mask) | (a[i] & mask));
+        }
+        ssd1306_mark_dirty(disp, (uint8_t)page, (uint8_t)sx0, (uint8_t)sx1);
+        painted += (size_t)n;
+    }
+    return painted;
+}
+
+int ssd1306_canvas_render(ssd1306_canvas_t *c) {
+    ssd1306_t *disp = c->disp;
+    int width = disp->geom.width, height = disp->geom.height;
+    int dx = c->x - c->shown_x, dy = c->y - c->shown_y;
+    size_t painted = 0;
+
+    if (!c->shown || abs(dx) >= width || abs(dy) >= height || (dy != 0 && !c->ring)) {
+        ssd1306_set_start_line(disp, c->ring ? (uint8_t)c->y : 0);
+        painted = ssd1306_canvas_paint(c, c->x, c->y, 0, width - 1, c->y, c->y + height);
+    } else {
+        if (dx != 0) {
+            // Keep the columns still in view and paint the exposed ones.
+            int keep = width - abs(dx);
+            for (uint8_t page = 0; page < disp->pages; page++) {
+                uint8_t *row = disp->fb[page];
+                if (dx > 0) {
+                    memmove(row, row + dx, (size_t)keep);
+                } else {
+                    memmove(row - dx, row, (size_t)keep);
+                }
+                ssd1306_mark_dirty(disp, page, 0, (uint8_t)(width - 1));
+            }
+            disp->view.hshift = (uint8_t)(disp->view.hshift - dx);
+            painted += ssd1306_canvas_paint(c, c->x, c->shown_y, dx > 0 ? keep : 0, dx > 0 ? width - 1 : -dx - 1,
+                                            c->shown_y, c->shown_y + height);
+        }
+        if (dy != 0) {
+            ssd1306_set_start_line(disp, (uint8_t)c->y);
+            painted += ssd1306_canvas_paint(c, c->x, c->y, 0, width - 1,
+                                            dy > 0 ? c->shown_y + height : c->y,
+                                            dy > 0 ? c->y + height : c->shown_y);
+        }
+    }
+    c->shown = 1;
+    c->shown_x = c->x;
+    c->shown_y = c->y;
+
+    // Redraw the damaged part of the window.
+    int x0 = c->dx0 > c->x ? c->dx0 : c->x, x1 = c->dx1 < c->x + width ? c->dx1 : c->x + width;
+    int y0 = c->dy0 > c->y ? c->dy0 : c->y, y1 = c->dy1 < c->y + height ? c->dy1 : c->y + height;
+    if (x0 < x1 && y0 < y1) {
+        painted += ssd1306_canvas_paint(c, c->x, c->y, x0 - c->x, x1 - 1 - c->x, y0, y1);
+    }
+    c->dx0 = c->dx1 = 0;
+    return (int)painted;
+}
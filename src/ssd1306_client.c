@@ -0,0 +1,200 @@
+#define _GNU_SOURCE
+#include "ssd1306_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// A client display's link to the server. The display's transport does
+// nothing: frames reach the server through the shared layer instead.
+struct ssd1306_client {
+    int sock;
+    ssd1306_layer_shm_t *shm;
+    uint8_t mask[SSD1306_PAGES * SSD1306_WIDTH];  // Layer region, copied into shm on present.
+    int mask_dirty;
+};
+
+static int ssd1306_client_xfer(void *ctx, const ssd1306_seg_t *segs, size_t nsegs) {
+    (void)ctx;
+    (void)segs;
+    (void)nsegs;
+    return 0;
+}
+
+static void ssd1306_client_close(void *ctx) {
+    struct ssd1306_client *client = ctx;
+    if (client->shm) {
+        munmap(client->shm, sizeof(*client->shm));
+    }
+    if (client->sock >= 0) {
+        close(client->sock);
+    }
+    free(client);
+}
+
+static const ssd1306_transport_ops_t ssd1306_client_ops = {
+    .name = "client",
+    .xfer = ssd1306_client_xfer,
+    .close = ssd1306_client_close,
+};
+
+// Private helper: create the layer, sealed so the server can map it without
+// fear of the client truncating it underneath.
+static int ssd1306_client_map(struct ssd1306_client *client) {
+    int fd = memfd_create("ssd1306-layer", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0) {
+        perror("ssd1306: Failed to create layer");
+        return -1;
+    }
+    if (ftruncate(fd, sizeof(*client->shm)) < 0 ||
+        fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) < 0) {
+        perror("ssd1306: Failed to size layer");
+        close(fd);
+        return -1;
+    }
+    void *shm = mmap(NULL, sizeof(*client->shm), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (shm == MAP_FAILED) {
+        perror("ssd1306: Failed to map layer");
+        close(fd);
+        return -1;
+    }
+    client->shm = shm;
+    return fd;
+}
+
+// Private helper: attach the layer at z and wait for the server's reply.
+static int ssd1306_client_attach(struct ssd1306_client *client, int fd, int z, ssd1306_geometry_t *geom) {
+    ssd1306_msg_t msg = { .type = MSG_ATTACH, .z = (int16_t)z };
+    union {
+        struct cmsghdr hdr;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } ctrl;
+    struct iovec iov = { &msg, sizeof(msg) };
+    struct msghdr mh = { .msg_iov = &iov, .msg_iovlen = 1, .msg_control = ctrl.buf, .msg_controllen = sizeof(ctrl.buf) };
+    struct cmsghdr *cm = CMSG_FIRSTHDR(&mh);
+    cm->cmsg_level = SOL_SOCKET;
+    cm->cmsg_type = SCM_RIGHTS;
+    cm->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cm), &fd, sizeof(int));
+    if (sendmsg(client->sock, &mh, MSG_NOSIGNAL) < 0) {
+        perror("ssd1306: Failed to attach layer");
+        return -1;
+    }
+    ssd1306_msg_t reply;
+    if (recv(client->sock, &reply, sizeof(reply), 0) != (ssize_t)sizeof(reply) ||
+        reply.type != MSG_WELCOME || reply.status != 0) {
+        fprintf(stderr, "ssd1306: Display server refused the layer\n");
+        return -1;
+    }
+    *geom = reply.geom;
+    return 0;
+}
+
+ssd1306_t *ssd1306_init_client(const char *path, int z) {
+    struct ssd1306_client *client = calloc(1, sizeof(*client));
+    if (!client) {
+        perror("ssd1306: Failed to allocate client");
+        return NULL;
+    }
+    client->sock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "ssd1306: Socket path too long: %s\n", path);
+        ssd1306_client_close(client);
+        return NULL;
+    }
+    strcpy(addr.sun_path, path);
+    if (client->sock < 0 || connect(client->sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        perror("ssd1306: Failed to connect to display server");
+        ssd1306_client_close(client);
+        return NULL;
+    }
+
+    ssd1306_geometry_t geom;
+    int fd = ssd1306_client_map(client);
+    int ret = fd < 0 ? -1 : ssd1306_client_attach(client, fd, z, &geom);
+    if (fd >= 0) {
+        close(fd);  // The mapping and the server's copy of the fd keep it alive.
+    }
+    if (ret < 0) {
+        ssd1306_client_close(client);
+        return NULL;
+    }
+    // The layer covers the whole panel until the client narrows it.
+    memset(client->mask, 0xFF, sizeof(client->mask));
+    client->mask_dirty = 1;
+
+    ssd1306_t *disp = ssd1306_init_transport(&ssd1306_client_ops, client);
+    if (!disp) {
+        return NULL;
+    }
+    disp->client = client;
+    if (ssd1306_set_geometry(disp, &geom) < 0) {
+        ssd1306_close(disp);
+        return NULL;
+    }
+    return disp;
+}
+
+void ssd1306_client_set_region(ssd1306_t *disp, int x, int y, int w, int h) {
+    struct ssd1306_client *client = disp->client;
+    if (!client) {
+        return;
+    }
+    memset(client->mask, 0, sizeof(client->mask));
+    int x1 = x + w > disp->geom.width ? disp->geom.width : x + w;
+    int y1 = y + h > disp->geom.height ? disp->geom.height : y + h;
+    x = x < 0 ? 0 : x;
+    y = y < 0 ? 0 : y;
+    for (int row = y; row < y1; row++) {
+        for (int col = x; col < x1; col++) {
+            client->mask[(row / 8) * SSD1306_WIDTH + col] |= (uint8_t)(1 << (row % 8));
+        }
+    }
+    client->mask_dirty = 1;
+}
+
+int ssd1306_client_present(ssd1306_t *disp) {
+    struct ssd1306_client *client = disp->client;
+    ssd1306_layer_shm_t *shm = client->shm;
+    uint32_t seq = atomic_load_explicit(&shm->seq, memory_order_relaxed);
+
+    atomic_store_explicit(&shm->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    // The server composites what the screen shows, so the start line is
+    // applied here: screen row r is RAM row (r + start_line) mod 64.
+    unsigned page_shift = disp->view.start_line / 8, bit_shift = disp->view.start_line % 8;
+    for (unsigned page = 0; page < disp->pages; page++) {
+        const uint8_t *a = disp->fb[(page + page_shift) % SSD1306_PAGES];
+        const uint8_t *b = disp->fb[(page + page_shift + 1) % SSD1306_PAGES];
+        uint8_t *dst = &shm->pixels[page * SSD1306_WIDTH];
+        if (bit_shift == 0) {
+            memcpy(dst, a, disp->geom.width);
+        } else {
+            for (unsigned c = 0; c < disp->geom.width; c++) {
+                dst[c] = (uint8_t)((a[c] >> bit_shift) | (b[c] << (8 - bit_shift)));
+            }
+        }
+    }
+    if (client->mask_dirty) {
+        memcpy(shm->mask, client->mask, sizeof(shm->mask));
+        client->mask_dirty = 0;
+    }
+
+    atomic_store_explicit(&shm->seq, seq + 2, memory_order_release);
+
+    // A full socket means updates are already queued, and the server reads
+    // the layer when it gets to them: this frame is not lost.
+    ssd1306_msg_t msg = { .type = MSG_UPDATE };
+    if (send(client->sock, &msg, sizeof(msg), MSG_NOSIGNAL | MSG_DONTWAIT) < 0 && errno != EAGAIN) {
+        perror("ssd1306: Failed to signal display server");
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,145 @@
+#include "ssd1306_internal.h"
+#include <string.h>
+#include <unistd.h>
+
+// Columns per character of the built-in 5x8 font, spacing included.
+#define GLYPH_COLS 6
+
+// Most characters per console line.
+#define CONSOLE_COLS (SSD1306_WIDTH / GLYPH_COLS)
+
+// Console lines are panel pages, and the pages form a ring: the start line
+// is kept page-aligned, the page it names is the top line on screen and
+// the page before it is the bottom line. The text cursor (page, col) is
+// the console cursor.
+//
+// The ring needs all 64 rows of RAM on screen. Shorter panels keep the
+// start line at 0 and move the text up in the framebuffer instead.
+
+void ssd1306_console_init(ssd1306_t *disp) {
+    ssd1306_clear_display(disp);
+    disp->view.start_line = 0;
+    disp->page = 0;
+    disp->col = 0;
+}
+
+void ssd1306_console_set_smooth(ssd1306_t *disp, unsigned step_us) {
+    disp->console_step_us = step_us;
+}
+
+// Private helper: move the text of a short panel up by rows (1-8) pixel
+// rows, clearing the rows it leaves at the bottom.
+static void ssd1306_console_shift(ssd1306_t *disp, int rows) {
+    uint8_t width = disp->geom.width;
+    for (uint8_t page = 0; page < disp->pages; page++) {
+        const uint8_t *below = page + 1 < disp->pages ? disp->fb[page + 1] : NULL;
+        uint8_t *row = disp->fb[page];
+        for (uint8_t c = 0; c < width; c++) {
+            unsigned next = below ? below[c] : 0;
+            row[c] = (uint8_t)((row[c] >> rows) | (next << (8 - rows)));
+        }
+        ssd1306_mark_dirty(disp, page, 0, width - 1);
+    }
+}
+
+// Private helper: newline on a panel shorter than the RAM ring.
+static int ssd1306_console_newline_short(ssd1306_t *disp) {
+    disp->col = 0;
+    if (disp->page + 1 < disp->pages) {
+        disp->page++;
+        return 0;
+    }
+    if (disp->console_step_us == 0) {
+        ssd1306_console_shift(disp, 8);
+        return 0;
+    }
+    int ret = 0;
+    for (int row = 0; row < 8; row++) {
+        if (row > 0) {
+            usleep(disp->console_step_us);
+        }
+        ssd1306_console_shift(disp, 1);
+        if (ssd1306_flush(disp) < 0) {
+            ret = -1;
+        }
+    }
+    return ret;
+}
+
+// Private helper: move the cursor to the start of the next line, scrolling
+// the oldest line out when the cursor is already on the bottom one.
+static int ssd1306_console_newline(ssd1306_t *disp) {
+    if (disp->pages < SSD1306_PAGES) {
+        return ssd1306_console_newline_short(disp);
+    }
+    uint8_t top = disp->view.start_line / 8;
+    uint8_t bottom = (top + SSD1306_PAGES - 1) & (SSD1306_PAGES - 1);
+
+    disp->col = 0;
+    if (disp->page != bottom) {
+        disp->page = (disp->page + 1) & (SSD1306_PAGES - 1);
+        return 0;
+    }
+
+    // The top page becomes the new bottom line: blank it and rotate the
+    // view by one page. Only its lit columns and one command hit the bus.
+    disp->page = top;
+    if (disp->console_step_us == 0) {
+        ssd1306_fill_rect(disp, 0, top * 8, SSD1306_WIDTH, 8, SSD1306_BLACK);
+        disp->view.start_line = (disp->view.start_line + 8) & (SSD1306_HEIGHT - 1);
+        return 0;
+    }
+
+    // Smooth scrolling rotates one pixel row per step. The row leaving the
+    // top reappears at the bottom, so it is blanked in the same transfer.
+    int ret = 0;
+    for (int row = 0; row < 8; row++) {
+        if (row > 0) {
+            usleep(disp->console_step_us);
+        }
+        ssd1306_fill_rect(disp, 0, top * 8 + row, SSD1306_WIDTH, 1, SSD1306_BLACK);
+        disp->view.start_line = (disp->view.start_line + 1) & (SSD1306_HEIGHT - 1);
+        if (ssd1306_flush(disp) < 0) {
+            ret = -1;
+        }
+    }
+    return ret;
+}
+
+int ssd1306_console_write(ssd1306_t *disp, const char *str) {
+    char run[CONSOLE_COLS + 1];
+    int ret = 0;
+
+    while (*str) {
+        if (*str == '\n') {
+            if (ssd1306_console_newline(disp) < 0) {
+                ret = -1;
+            }
+            str++;
+            continue;
+        }
+        if (*str == '\r') {
+            disp->col = 0;
+            str++;
+            continue;
+        }
+        size_t room = (size_t)(disp->geom.width - disp->col) / GLYPH_COLS;
+        if (room == 0) {
+            if (ssd1306_console_newline(disp) < 0) {
+                ret = -1;
+            }
+            continue;
+        }
+
+        // Draw as much of the line as fits in one run.
+        size_t len = strcspn(str, "\r\n");
+        if (len > room) {
+            len = room;
+        }
+        memcpy(run, str, len);
+        run[len] = '\0';
+        ssd1306_draw_string(disp, run);
+        str += len;
+    }
+    return ret;
+}
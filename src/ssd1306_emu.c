@@ -0,0 +1,368 @@
+#include "ssd1306_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Hardware scroll intervals in frames per step, indexed by command code.
+static const uint16_t emu_scroll_frames[8] = { 5, 64, 128, 256, 3, 4, 25, 2 };
+
+// Longest command: opcode plus six parameter bytes.
+#define EMU_MAX_CMD 7
+
+struct ssd1306_emu {
+    uint8_t ram[SSD1306_PAGES][SSD1306_WIDTH];
+    uint8_t written[SSD1306_PAGES][SSD1306_WIDTH]; // Nonzero once a byte has been written.
+    ssd1306_emu_state_t st;
+    uint8_t page, col;                 // RAM pointer.
+    uint8_t cmd[EMU_MAX_CMD];          // Command being collected across segments,
+    size_t cmd_len, cmd_need;          // its bytes so far and its full length.
+    uint8_t scroll_cmd[EMU_MAX_CMD];   // Last scroll setup, run by 0x2F.
+    unsigned long scroll_phase;        // Frames since the last scroll step.
+    ssd1306_emu_stats_t stats;
+};
+
+ssd1306_emu_t *ssd1306_emu_create(void) {
+    ssd1306_emu_t *emu = calloc(1, sizeof(*emu));
+    if (!emu) {
+        perror("ssd1306: Failed to allocate emulator");
+        return NULL;
+    }
+    ssd1306_emu_reset(emu);
+    return emu;
+}
+
+void ssd1306_emu_destroy(ssd1306_emu_t *emu) {
+    free(emu);
+}
+
+void ssd1306_emu_reset(ssd1306_emu_t *emu) {
+    memset(emu, 0, sizeof(*emu));
+    // Reset values from the datasheet; RAM content is undefined at power-up.
+    emu->st.addr_mode = 2;
+    emu->st.col_end = SSD1306_WIDTH - 1;
+    emu->st.page_end = SSD1306_PAGES - 1;
+    emu->st.mux = SSD1306_HEIGHT;
+    emu->st.contrast = 0x7F;
+    emu->st.com_pins = 0x12;
+    emu->st.area_rows = SSD1306_HEIGHT;
+}
+
+// Private helper: bytes in the command starting with op, opcode included.
+static size_t ssd1306_emu_cmd_len(uint8_t op) {
+    switch (op) {
+    case 0x81: case 0x8D: case 0x20: case 0xA8: case 0xD3:
+    case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+        return 2;
+    case 0x21: case 0x22: case 0xA3:
+        return 3;
+    case 0x29: case 0x2A:
+        return 6;
+    case 0x26: case 0x27: case 0x2C: case 0x2D:
+        return 7;
+    default:
+        return 1;
+    }
+}
+
+// Private helper: rotate RAM by one column over pages p0..p1 and columns
+// c0..c1. The controller shifts RAM itself, so the content stays shifted
+// after a scroll stops.
+static void ssd1306_emu_shift(ssd1306_emu_t *emu, unsigned p0, unsigned p1, unsigned c0, unsigned c1, int right) {
+    if (c1 <= c0) {
+        return;
+    }
+    size_t n = c1 - c0;
+    for (unsigned page = p0; page <= p1 && page < SSD1306_PAGES; page++) {
+        uint8_t *row = &emu->ram[page][c0];
+        if (right) {
+            uint8_t last = row[n];
+            memmove(row + 1, row, n);
+            row[0] = last;
+        } else {
+            uint8_t first = row[0];
+            memmove(row, row + 1, n);
+            row[n] = first;
+        }
+    }
+}
+
+// Private helper: one step of the running scroll.
+static void ssd1306_emu_scroll_step(ssd1306_emu_t *emu) {
+    ssd1306_emu_state_t *st = &emu->st;
+    uint8_t op = emu->scroll_cmd[0];
+    if (op == 0x26 || op == 0x27 || ((op == 0x29 || op == 0x2A) && emu->scroll_cmd[1])) {
+        ssd1306_emu_shift(emu, st->scroll_start_page, st->scroll_end_page,
+                          st->scroll_start_col, st->scroll_end_col, op == 0x26 || op == 0x29);
+    }
+    if ((op == 0x29 || op == 0x2A) && st->area_rows) {
+        st->vscroll = (uint8_t)((st->vscroll + emu->scroll_cmd[5]) % st->area_rows);
+    }
+}
+
+// Private helper: execute a complete command.
+static void ssd1306_emu_exec(ssd1306_emu_t *emu, const uint8_t *c) {
+    ssd1306_emu_state_t *st = &emu->st;
+    uint8_t op = c[0];
+
+    if (op <= 0x0F) {
+        emu->col = (uint8_t)((emu->col & 0xF0) | op);
+    } else if (op <= 0x1F) {
+        emu->col = (uint8_t)(((op & 0x07) << 4) | (emu->col & 0x0F));
+    } else if (op >= 0x40 && op <= 0x7F) {
+        st->start_line = op & 0x3F;
+        st->vscroll = 0;
+    } else if (op >= 0xB0 && op <= 0xB7) {
+        emu->page = op & 0x07;
+    } else if (op >= 0xC0 && op <= 0xCF) {
+        st->com_remap = (op & 0x08) != 0;
+    } else {
+        switch (op) {
+        case 0x20:
+            st->addr_mode = c[1] & 0x03;
+            break;
+        case 0x21:
+            st->col_start = c[1] & 0x7F;
+            st->col_end = c[2] & 0x7F;
+            emu->col = st->col_start;
+            break;
+        case 0x22:
+            st->page_start = c[1] & 0x07;
+            st->page_end = c[2] & 0x07;
+            emu->page = st->page_start;
+            break;
+        case 0x81:
+            st->contrast = c[1];
+            break;
+        case 0x8D:
+            st->charge_pump = (c[1] & 0x04) != 0;
+            break;
+        case 0xA0: case 0xA1:
+            st->seg_remap = op & 1;
+            break;
+        case 0xA3:
+            st->area_top = c[1] & 0x3F;
+            st->area_rows = c[2] & 0x7F;
+            break;
+        case 0xA4: case 0xA5:
+            st->entire_on = op & 1;
+            break;
+        case 0xA6: case 0xA7:
+            st->inverted = op & 1;
+            break;
+        case 0xA8:
+            st->mux = (uint8_t)((c[1] & 0x3F) + 1);
+            break;
+        case 0xAE: case 0xAF:
+            st->display_on = op & 1;
+            break;
+        case 0xD3:
+            st->offset = c[1] & 0x3F;
+            break;
+        case 0xDA:
+            st->com_pins = c[1];
+            break;
+        case 0xD5: case 0xD9: case 0xDB: case 0xE3:
+            break;
+        case 0x26: case 0x27:
+            // Start page, interval, end page, then the column range; the
+            // common 0x00/0xFF dummy bytes mean every column.
+            memcpy(emu->scroll_cmd, c, 7);
+            st->scroll_start_page = c[2] & 0x07;
+            st->scroll_interval = emu_scroll_frames[c[3] & 0x07];
+            st->scroll_end_page = c[4] & 0x07;
+            st->scroll_start_col = c[5] & 0x7F;
+            st->scroll_end_col = c[6] > 0x7F ? 0x7F : c[6];
+            break;
+        case 0x29: case 0x2A:
+            memcpy(emu->scroll_cmd, c, 6);
+            st->scroll_start_page = c[2] & 0x07;
+            st->scroll_interval = emu_scroll_frames[c[3] & 0x07];
+            st->scroll_end_page = c[4] & 0x07;
+            st->scroll_start_col = 0;
+            st->scroll_end_col = SSD1306_WIDTH - 1;
+            break;
+        case 0x2C: case 0x2D:
+            // Content scroll: one column now, over pages c[2]..c[4] and
+            // columns c[5]..c[6]. Ignored while a scroll runs.
+            if (!st->scrolling) {
+                ssd1306_emu_shift(emu, c[2] & 0x07, c[4] & 0x07, c[5] & 0x7F, c[6] & 0x7F, op == 0x2C);
+                emu->stats.content_shifts++;
+            }
+            break;
+        case 0x2E:
+            st->scrolling = 0;
+            break;
+        case 0x2F:
+            st->scrolling = emu->scroll_cmd[0] != 0;
+            emu->scroll_phase = 0;
+            break;
+        default:
+            emu->stats.bad_cmds++;
+            break;
+        }
+    }
+}
+
+// Private helper: store one data byte at the RAM pointer and advance it the
+// way the addressing mode does.
+static void ssd1306_emu_data(ssd1306_emu_t *emu, uint8_t b) {
+    ssd1306_emu_state_t *st = &emu->st;
+    uint8_t *cell = &emu->ram[emu->page & 7][emu->col & 0x7F];
+    if (emu->written[emu->page & 7][emu->col & 0x7F] && *cell == b) {
+        emu->stats.redundant_bytes++;
+    }
+    *cell = b;
+    emu->written[emu->page & 7][emu->col & 0x7F] = 1;
+
+    switch (st->addr_mode) {
+    case 0: // Horizontal: along the window row, then down to the next page.
+        if (emu->col >= st->col_end) {
+            emu->col = st->col_start;
+            emu->page = emu->page >= st->page_end ? st->page_start : emu->page + 1;
+        } else {
+            emu->col++;
+        }
+        break;
+    case 1: // Vertical: down the window column, then right.
+        if (emu->page >= st->page_end) {
+            emu->page = st->page_start;
+            emu->col = emu->col >= st->col_end ? st->col_start : emu->col + 1;
+        } else {
+            emu->page++;
+        }
+        break;
+    default: // Page: along the page, wrapping within it.
+        emu->col = (uint8_t)((emu->col + 1) & 0x7F);
+        break;
+    }
+}
+
+int ssd1306_emu_write(void *user, uint8_t ctrl, const uint8_t *buf, size_t len) {
+    ssd1306_emu_t *emu = user;
+    emu->stats.segs++;
+    emu->stats.i2c_bytes += len + 2;
+    if (ctrl == SSD1306_CTRL_DATA) {
+        emu->stats.data_bytes += len;
+        for (size_t i = 0; i < len; i++) {
+            ssd1306_emu_data(emu, buf[i]);
+        }
+        return 0;
+    }
+    emu->stats.cmd_bytes += len;
+    for (size_t i = 0; i < len; i++) {
+        if (emu->cmd_len == 0) {
+            emu->cmd_need = ssd1306_emu_cmd_len(buf[i]);
+        }
+        emu->cmd[emu->cmd_len++] = buf[i];
+        if (emu->cmd_len == emu->cmd_need) {
+            ssd1306_emu_exec(emu, emu->cmd);
+            emu->cmd_len = 0;
+        }
+    }
+    return 0;
+}
+
+void ssd1306_emu_advance(ssd1306_emu_t *emu, unsigned frames) {
+    if (!emu->st.scrolling) {
+        return;
+    }
+    emu->scroll_phase += frames;
+    while (emu->scroll_phase >= emu->st.scroll_interval) {
+        emu->scroll_phase -= emu->st.scroll_interval;
+        ssd1306_emu_scroll_step(emu);
+    }
+}
+
+int ssd1306_emu_pixel(const ssd1306_emu_t *emu, int x, int y) {
+    const ssd1306_emu_state_t *st = &emu->st;
+    if (x < 0 || x >= SSD1306_WIDTH || y < 0 || y >= st->mux || !st->display_on) {
+        return 0;
+    }
+    if (st->entire_on) {
+        return 1;
+    }
+    // The library's orientation (0xA1, 0xC8) is upright; the other settings
+    // mirror the picture.
+    int col = st->seg_remap ? x : SSD1306_WIDTH - 1 - x;
+    int row = st->com_remap ? y : st->mux - 1 - y;
+    int line = row + st->start_line + st->offset;
+    if (row >= st->area_top && row < st->area_top + st->area_rows) {
+        line += st->vscroll;
+    }
+    line &= SSD1306_HEIGHT - 1;
+    int on = (emu->ram[line / 8][col] >> (line % 8)) & 1;
+    return on ^ st->inverted;
+}
+
+int ssd1306_emu_write_pbm(const ssd1306_emu_t *emu, const char *path, const ssd1306_geometry_t *geom) {
+    int x0 = geom ? geom->col_offset : 0, w = geom ? geom->width : SSD1306_WIDTH;
+    int h = geom ? geom->height : emu->st.mux;
+    FILE *fp = fopen(path, "wb");
+    if (!fp) {
+        perror("ssd1306: Failed to open image");
+        return -1;
+    }
+    fprintf(fp, "P4\n%d %d\n", w, h);
+    for (int y = 0; y < h; y++) {
+        uint8_t row[SSD1306_WIDTH / 8] = { 0 };
+        for (int x = 0; x < w; x++) {
+            row[x / 8] |= (uint8_t)(ssd1306_emu_pixel(emu, x0 + x, y) << (7 - x % 8));
+        }
+        fwrite(row, 1, (size_t)(w + 7) / 8, fp);
+    }
+    if (fclose(fp) != 0) {
+        perror("ssd1306: Failed to write image");
+        return -1;
+    }
+    return 0;
+}
+
+const uint8_t *ssd1306_emu_ram(const ssd1306_emu_t *emu) {
+    return &emu->ram[0][0];
+}
+
+void ssd1306_emu_get_state(const ssd1306_emu_t *emu, ssd1306_emu_state_t *state) {
+    *state = emu->st;
+}
+
+void ssd1306_emu_get_stats(const ssd1306_emu_t *emu, ssd1306_emu_stats_t *stats) {
+    *stats = emu->stats;
+}
+
+void ssd1306_emu_reset_stats(ssd1306_emu_t *emu) {
+    memset(&emu->stats, 0, sizeof(emu->stats));
+}
+
+// -------------------------------------------------
+// Emulator transport: a display whose bus ends in an emulator.
+
+static int ssd1306_emu_xfer(void *ctx, const ssd1306_seg_t *segs, size_t nsegs) {
+    ssd1306_emu_t *emu = *(ssd1306_emu_t **)ctx;
+    for (size_t i = 0; i < nsegs; i++) {
+        if (segs[i].len > 0) {
+            ssd1306_emu_write(emu, segs[i].ctrl, segs[i].buf, segs[i].len);
+        }
+    }
+    emu->stats.xfers++;
+    return 0;
+}
+
+static void ssd1306_emu_close(void *ctx) {
+    free(ctx);
+}
+
+static const ssd1306_transport_ops_t ssd1306_emu_ops = {
+    .name = "emu",
+    .xfer = ssd1306_emu_xfer,
+    .close = ssd1306_emu_close,
+};
+
+ssd1306_t *ssd1306_init_emu(ssd1306_emu_t *emu) {
+    ssd1306_emu_t **ctx = malloc(sizeof(*ctx));
+    if (!ctx) {
+        perror("ssd1306: Failed to allocate emulator transport");
+        return NULL;
+    }
+    *ctx = emu;
+    return ssd1306_init_transport(&ssd1306_emu_ops, ctx);
+}
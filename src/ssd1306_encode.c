@@ -0,0 +1,217 @@
+#include "ssd1306_internal.h"
+#include <string.h>
+
+// Command bytes of a page-mode cursor (page, lower and higher column) and
+// of an address window (0x21 c0 c1 0x22 p0 p1).
+#define CURSOR_BYTES 3
+#define WINDOW_BYTES 6
+
+typedef struct {
+    uint8_t lo, hi;
+} ssd1306_span_t;
+
+void ssd1306_enc_init(ssd1306_enc_t *enc, const uint8_t *window) {
+    enc->nsegs = 0;
+    enc->ncmds = 0;
+    memcpy(enc->window, window, sizeof(enc->window));
+    memset(enc->lo, DIRTY_NONE, sizeof(enc->lo));
+    memset(enc->hi, 0, sizeof(enc->hi));
+    memset(&enc->report, 0, sizeof(enc->report));
+}
+
+// Private helper: whether data at this address continues the last segment.
+static int ssd1306_enc_continues(const ssd1306_enc_t *enc, uint8_t ctrl, const uint8_t *data) {
+    const ssd1306_seg_t *last = enc->nsegs ? &enc->segs[enc->nsegs - 1] : NULL;
+    return last && last->ctrl == ctrl && last->buf + last->len == data;
+}
+
+// Private helper: append a segment, or extend the last one when contiguous.
+static void ssd1306_enc_seg(ssd1306_enc_t *enc, uint8_t ctrl, const uint8_t *buf, size_t n) {
+    if (ssd1306_enc_continues(enc, ctrl, buf)) {
+        enc->segs[enc->nsegs - 1].len += n;
+    } else if (enc->nsegs < ENC_MAX_SEGS) {
+        enc->segs[enc->nsegs++] = (ssd1306_seg_t){ ctrl, buf, n };
+    }
+}
+
+void ssd1306_enc_cmd(ssd1306_enc_t *enc, const uint8_t *cmds, size_t n) {
+    if (n == 0 || n > ENC_CMD_BYTES - enc->ncmds) {
+        return;
+    }
+    uint8_t *dst = &enc->cmds[enc->ncmds];
+    memcpy(dst, cmds, n);
+    enc->ncmds += n;
+    ssd1306_enc_seg(enc, SSD1306_CTRL_CMD, dst, n);
+    enc->report.cmd_bytes += n;
+}
+
+void ssd1306_enc_data(ssd1306_enc_t *enc, const uint8_t *data, size_t n) {
+    if (n == 0) {
+        return;
+    }
+    ssd1306_enc_seg(enc, SSD1306_CTRL_DATA, data, n);
+    enc->report.data_bytes += n;
+}
+
+// Private helper: modeled bus time of segs segments carrying bytes bytes.
+static uint32_t ssd1306_enc_cost(const ssd1306_cost_t *cost, size_t segs, size_t bytes) {
+    return (uint32_t)(segs * cost->seg_ns + bytes * cost->byte_ns);
+}
+
+// Private helper: the changed runs of columns lo..hi of a page. Runs closer
+// than gap_max columns are joined, since resending a few unchanged bytes is
+// cheaper than another cursor command and segment pair.
+static size_t ssd1306_enc_spans(const ssd1306_t *disp, const uint8_t *row, uint8_t page,
+                                uint8_t lo, uint8_t hi, unsigned gap_max, ssd1306_span_t *spans) {
+    if (!disp->shadow_valid) {
+        spans[0] = (ssd1306_span_t){ lo, hi };
+        return 1;
+    }
+    const uint8_t *old = disp->shadow[page];
+    size_t n = 0;
+    for (unsigned c = lo; c <= hi; c++) {
+        if (row[c] == old[c]) {
+            continue;
+        }
+        if (n > 0 && (c - spans[n - 1].hi - 1 <= gap_max || n == ENC_SPANS_PER_PAGE)) {
+            spans[n - 1].hi = (uint8_t)c;
+        } else {
+            spans[n++] = (ssd1306_span_t){ (uint8_t)c, (uint8_t)c };
+        }
+    }
+    return n;
+}
+
+void ssd1306_encode(const ssd1306_t *disp, const uint8_t *frame,
+                    const uint8_t *dirty_lo, const uint8_t *dirty_hi,
+                    uint8_t frozen, uint8_t repaint, ssd1306_enc_t *enc) {
+    ssd1306_span_t spans[SSD1306_PAGES][ENC_SPANS_PER_PAGE];
+    size_t nspans[SSD1306_PAGES];
+    const ssd1306_cost_t *cost = &disp->cost;
+    ssd1306_flush_report_t *report = &enc->report;
+
+    unsigned gap_max = CURSOR_BYTES;
+    if (cost->byte_ns > 0) {
+        gap_max = (CURSOR_BYTES * cost->byte_ns + 2 * cost->seg_ns) / cost->byte_ns;
+    }
+
+    // Find the changed spans, and what each plan would send for them.
+    size_t data = 0, runs = 0, prev_end = (size_t)-1;
+    int p0 = -1, p1 = -1;
+    unsigned c0 = SSD1306_WIDTH - 1, c1 = 0;
+    uint8_t width = disp->geom.width, pages = disp->pages;
+    for (uint8_t page = 0; page < pages; page++) {
+        const uint8_t *row = frame + (size_t)page * SSD1306_WIDTH;
+        size_t n;
+        nspans[page] = 0;
+        if (frozen & (1u << page)) {
+            continue;
+        } else if (repaint & (1u << page)) {
+            spans[page][0] = (ssd1306_span_t){ 0, (uint8_t)(width - 1) };
+            n = 1;
+        } else if (dirty_lo[page] >= width) {
+            continue;
+        } else {
+            uint8_t hi = dirty_hi[page] < width ? dirty_hi[page] : (uint8_t)(width - 1);
+            n = ssd1306_enc_spans(disp, row, page, dirty_lo[page], hi, gap_max, spans[page]);
+            if (n == 0) {
+                continue;
+            }
+        }
+        nspans[page] = n;
+        report->spans += n;
+        for (size_t i = 0; i < n; i++) {
+            size_t start = (size_t)page * SSD1306_WIDTH + spans[page][i].lo;
+            data += spans[page][i].hi - spans[page][i].lo + 1u;
+            // A span that starts where the last one ended (at the end of a
+            // page) needs no cursor: the RAM pointer is already there.
+            if (start != prev_end) {
+                runs++;
+            }
+            prev_end = (size_t)page * SSD1306_WIDTH + spans[page][i].hi + 1;
+        }
+        enc->lo[page] = spans[page][0].lo;
+        enc->hi[page] = spans[page][n - 1].hi;
+        if (p0 < 0) {
+            p0 = page;
+        }
+        p1 = page;
+        c0 = enc->lo[page] < c0 ? enc->lo[page] : c0;
+        c1 = enc->hi[page] > c1 ? enc->hi[page] : c1;
+    }
+    if (report->spans == 0) {
+        report->plan = SSD1306_PLAN_NONE;
+        return;
+    }
+
+    // Page-mode cursors only address the panel correctly through the full
+    // window, so a narrowed window is reset first.
+    int full_window = enc->window[0] == 0 && enc->window[1] == width - 1 &&
+                      enc->window[2] == 0 && enc->window[3] == pages - 1;
+    size_t area = (size_t)(c1 - c0 + 1) * (size_t)(p1 - p0 + 1);
+    report->spans_ns = ssd1306_enc_cost(cost, 2 * runs,
+                                        CURSOR_BYTES * runs + data + (full_window ? 0 : WINDOW_BYTES));
+    // A window or full frame also writes whatever lies between the changes,
+    // so neither may cover a page held by a running hardware scroll.
+    if (!(frozen & (uint8_t)((0xFFu << p0) & (0xFFu >> (7 - p1))))) {
+        report->window_ns = ssd1306_enc_cost(cost, 2, WINDOW_BYTES + area);
+    }
+    if (!frozen) {
+        report->full_ns = ssd1306_enc_cost(cost, 2, WINDOW_BYTES + (size_t)pages * width);
+    }
+
+    report->plan = SSD1306_PLAN_SPANS;
+    if (report->window_ns && report->window_ns < report->spans_ns) {
+        report->plan = area == (size_t)pages * width ? SSD1306_PLAN_FULL : SSD1306_PLAN_WINDOW;
+    }
+
+    // Framebuffer column 0 is controller column col_offset.
+    uint8_t off = disp->geom.col_offset;
+    if (report->plan == SSD1306_PLAN_SPANS) {
+        if (!full_window) {
+            uint8_t reset[WINDOW_BYTES] = { 0x21, off, (uint8_t)(off + width - 1), 0x22, 0, (uint8_t)(pages - 1) };
+            ssd1306_enc_cmd(enc, reset, sizeof(reset));
+            enc->window[0] = 0;
+            enc->window[1] = (uint8_t)(width - 1);
+            enc->window[2] = 0;
+            enc->window[3] = (uint8_t)(pages - 1);
+        }
+        for (uint8_t page = 0; page < pages; page++) {
+            for (size_t i = 0; i < nspans[page]; i++) {
+                const uint8_t *ptr = frame + (size_t)page * SSD1306_WIDTH + spans[page][i].lo;
+                if (!ssd1306_enc_continues(enc, SSD1306_CTRL_DATA, ptr)) {
+                    uint8_t col = (uint8_t)(off + spans[page][i].lo);
+                    uint8_t cursor[CURSOR_BYTES] = {
+                        0xB0 | page,                    // Set page address
+                        0x00 | (col & 0x0F),            // Set lower column start address
+                        0x10 | ((col >> 4) & 0x0F),     // Set higher column start address
+                    };
+                    ssd1306_enc_cmd(enc, cursor, sizeof(cursor));
+                }
+                ssd1306_enc_data(enc, ptr, spans[page][i].hi - spans[page][i].lo + 1u);
+            }
+        }
+        return;
+    }
+
+    // One window around every change, streamed as a single data segment.
+    uint8_t cmds[WINDOW_BYTES] = { 0x21, (uint8_t)(off + c0), (uint8_t)(off + c1), 0x22, (uint8_t)p0, (uint8_t)p1 };
+    ssd1306_enc_cmd(enc, cmds, sizeof(cmds));
+    if (c0 == 0 && c1 == SSD1306_WIDTH - 1) {
+        ssd1306_enc_data(enc, frame + (size_t)p0 * SSD1306_WIDTH, area);
+    } else {
+        size_t cols = c1 - c0 + 1;
+        for (int page = p0; page <= p1; page++) {
+            memcpy(&enc->stage[(page - p0) * cols], frame + (size_t)page * SSD1306_WIDTH + c0, cols);
+        }
+        ssd1306_enc_data(enc, enc->stage, area);
+    }
+    enc->window[0] = (uint8_t)c0;
+    enc->window[1] = (uint8_t)c1;
+    enc->window[2] = (uint8_t)p0;
+    enc->window[3] = (uint8_t)p1;
+    for (int page = p0; page <= p1; page++) {
+        enc->lo[page] = (uint8_t)c0;
+        enc->hi[page] = (uint8_t)c1;
+    }
+}
@@ -0,0 +1,42 @@
+#include "ssd1306_internal.h"
+
+int ssd1306_glyph_index(const ssd1306_font_t *font, char ch) {
+    unsigned char c = (unsigned char)ch;
+    if (c >= font->first && c <= font->last) {
+        return c - font->first;
+    }
+    if ('?' >= font->first && '?' <= font->last) {
+        return '?' - font->first;
+    }
+    return -1;
+}
+
+int ssd1306_draw_text_font(ssd1306_t *disp, const ssd1306_font_t *font, int x, int y, const char *str) {
+    int pages = font->height / 8;
+
+    for (; *str && x < disp->geom.width; str++) {
+        int idx = ssd1306_glyph_index(font, *str);
+        if (idx < 0) {
+            continue;
+        }
+        uint8_t width = font->widths[idx];
+        const uint8_t *glyph = font->bitmap + font->offsets[idx];
+        for (int p = 0; p < pages; p++) {
+            ssd1306_blit_strip(disp, x, y + p * 8, glyph + p * width, width);
+        }
+        x += width;
+    }
+    // Account for the rest of the string so the return value is the true end.
+    return x + ssd1306_text_width(font, str);
+}
+
+int ssd1306_text_width(const ssd1306_font_t *font, const char *str) {
+    int width = 0;
+    for (; *str; str++) {
+        int idx = ssd1306_glyph_index(font, *str);
+        if (idx >= 0) {
+            width += font->widths[idx];
+        }
+    }
+    return width;
+}
@@ -0,0 +1,344 @@
+#include "ssd1306_internal.h"
+#include <stdlib.h>
+#include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// Every color is applied to a framebuffer byte as (byte & keep) ^ flip,
+// with both masks derived from the bits being drawn:
+//   WHITE:  keep = ~bits, flip = bits   (set)
+//   BLACK:  keep = ~bits, flip = 0      (clear)
+//   INVERT: keep = 0xFF,  flip = bits   (toggle)
+static inline void ssd1306_color_masks(int color, uint8_t bits, uint8_t *keep, uint8_t *flip) {
+    *keep = color == SSD1306_INVERT ? 0xFF : (uint8_t)~bits;
+    *flip = color == SSD1306_BLACK ? 0x00 : bits;
+}
+
+// Private helper: apply one page mask to n consecutive column bytes.
+// Runs 16 columns per step with SSE2/NEON when available, then 8 columns
+// per 64-bit word, then single bytes.
+static void ssd1306_mask_span(uint8_t *row, size_t n, uint8_t bits, int color) {
+    uint8_t keep, flip;
+    size_t i = 0;
+    ssd1306_color_masks(color, bits, &keep, &flip);
+
+#if defined(__SSE2__)
+    const __m128i keep128 = _mm_set1_epi8((char)keep);
+    const __m128i flip128 = _mm_set1_epi8((char)flip);
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(row + i));
+        v = _mm_xor_si128(_mm_and_si128(v, keep128), flip128);
+        _mm_storeu_si128((__m128i *)(row + i), v);
+    }
+#elif defined(__ARM_NEON)
+    const uint8x16_t keep128 = vdupq_n_u8(keep);
+    const uint8x16_t flip128 = vdupq_n_u8(flip);
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t v = vld1q_u8(row + i);
+        vst1q_u8(row + i, veorq_u8(vandq_u8(v, keep128), flip128));
+    }
+#endif
+    const uint64_t keep64 = keep * 0x0101010101010101ULL;
+    const uint64_t flip64 = flip * 0x0101010101010101ULL;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t v;
+        memcpy(&v, row + i, sizeof(v));
+        v = (v & keep64) ^ flip64;
+        memcpy(row + i, &v, sizeof(v));
+    }
+    for (; i < n; i++) {
+        row[i] = (uint8_t)((row[i] & keep) ^ flip);
+    }
+}
+
+// Private helper: plot one pixel that is known to be on the panel.
+static inline void ssd1306_plot(ssd1306_t *disp, int x, int y, int color) {
+    uint8_t keep, flip;
+    uint8_t *byte = &disp->fb[y >> 3][x];
+    ssd1306_color_masks(color, (uint8_t)(1 << (y & 7)), &keep, &flip);
+    *byte = (uint8_t)((*byte & keep) ^ flip);
+    ssd1306_mark_dirty(disp, (uint8_t)(y >> 3), (uint8_t)x, (uint8_t)x);
+}
+
+// Private helper: plot one pixel, ignoring it if it is off the panel.
+static inline void ssd1306_plot_clipped(ssd1306_t *disp, int x, int y, int color) {
+    if (x >= 0 && x < disp->geom.width && y >= 0 && y < disp->geom.height) {
+        ssd1306_plot(disp, x, y, color);
+    }
+}
+
+void ssd1306_fill_rect(ssd1306_t *disp, int x, int y, int w, int h, int color) {
+    int x1 = x + w - 1, y1 = y + h - 1;
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    if (x < 0) {
+        x = 0;
+    }
+    if (y < 0) {
+        y = 0;
+    }
+    if (x1 >= disp->geom.width) {
+        x1 = disp->geom.width - 1;
+    }
+    if (y1 >= disp->geom.height) {
+        y1 = disp->geom.height - 1;
+    }
+    if (x > x1 || y > y1) {
+        return;
+    }
+
+    // Each page is one masked pass over the columns: the top and bottom
+    // pages get partial masks, the pages in between are whole bytes.
+    size_t n = (size_t)(x1 - x + 1);
+    for (int page = y >> 3; page <= y1 >> 3; page++) {
+        uint8_t bits = 0xFF;
+        if (page == y >> 3) {
+            bits &= (uint8_t)(0xFF << (y & 7));
+        }
+        if (page == y1 >> 3) {
+            bits &= (uint8_t)(0xFF >> (7 - (y1 & 7)));
+        }
+        if (bits == 0xFF && color != SSD1306_INVERT) {
+            memset(&disp->fb[page][x], color == SSD1306_WHITE ? 0xFF : 0x00, n);
+        } else {
+            ssd1306_mask_span(&disp->fb[page][x], n, bits, color);
+        }
+        ssd1306_mark_dirty(disp, (uint8_t)page, (uint8_t)x, (uint8_t)x1);
+    }
+}
+
+void ssd1306_draw_hline(ssd1306_t *disp, int x, int y, int w, int color) {
+    ssd1306_fill_rect(disp, x, y, w, 1, color);
+}
+
+void ssd1306_draw_vline(ssd1306_t *disp, int x, int y, int h, int color) {
+    ssd1306_fill_rect(disp, x, y, 1, h, color);
+}
+
+void ssd1306_draw_rect(ssd1306_t *disp, int x, int y, int w, int h, int color) {
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    ssd1306_draw_hline(disp, x, y, w, color);
+    if (h > 1) {
+        ssd1306_draw_hline(disp, x, y + h - 1, w, color);
+    }
+    // The sides skip the corners so INVERT does not toggle them twice.
+    if (h > 2) {
+        ssd1306_draw_vline(disp, x, y + 1, h - 2, color);
+        if (w > 1) {
+            ssd1306_draw_vline(disp, x + w - 1, y + 1, h - 2, color);
+        }
+    }
+}
+
+void ssd1306_draw_line(ssd1306_t *disp, int x0, int y0, int x1, int y1, int color) {
+    if (y0 == y1) {
+        ssd1306_draw_hline(disp, x0 < x1 ? x0 : x1, y0, abs(x1 - x0) + 1, color);
+        return;
+    }
+    if (x0 == x1) {
+        ssd1306_draw_vline(disp, x0, y0 < y1 ? y0 : y1, abs(y1 - y0) + 1, color);
+        return;
+    }
+
+    // Bresenham.
+    int dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+    int dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+    int err = dx + dy;
+    for (;;) {
+        ssd1306_plot_clipped(disp, x0, y0, color);
+        if (x0 == x1 && y0 == y1) {
+            break;
+        }
+        int e2 = 2 * err;
+        if (e2 >= dy) {
+            err += dy;
+            x0 += sx;
+        }
+        if (e2 <= dx) {
+            err += dx;
+            y0 += sy;
+        }
+    }
+}
+
+void ssd1306_draw_circle(ssd1306_t *disp, int cx, int cy, int r, int color) {
+    if (r < 0) {
+        return;
+    }
+    if (r == 0) {
+        ssd1306_plot_clipped(disp, cx, cy, color);
+        return;
+    }
+
+    // Midpoint circle, one octant mirrored eight ways. Points that two
+    // octants share (on the axes and diagonals) are plotted once.
+    int x = r, y = 0, err = 1 - r;
+    while (x >= y) {
+        ssd1306_plot_clipped(disp, cx + x, cy + y, color);
+        ssd1306_plot_clipped(disp, cx - x, cy - y, color);
+        if (y != 0) {
+            ssd1306_plot_clipped(disp, cx + x, cy - y, color);
+            ssd1306_plot_clipped(disp, cx - x, cy + y, color);
+        }
+        if (x != y) {
+            ssd1306_plot_clipped(disp, cx + y, cy + x, color);
+            ssd1306_plot_clipped(disp, cx - y, cy - x, color);
+            if (y != 0) {
+                ssd1306_plot_clipped(disp, cx - y, cy + x, color);
+                ssd1306_plot_clipped(disp, cx + y, cy - x, color);
+            }
+        }
+        y++;
+        if (err < 0) {
+            err += 2 * y + 1;
+        } else {
+            x--;
+            err += 2 * (y - x) + 1;
+        }
+    }
+}
+
+void ssd1306_draw_bitmap(ssd1306_t *disp, int x, int y, const uint8_t *bitmap, int w, int h, int color) {
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    int c0 = x < 0 ? -x : 0;
+    int c1 = x + w > disp->geom.width ? disp->geom.width - x : w;
+    if (c0 >= c1) {
+        return;
+    }
+
+    int src_pages = (h + 7) / 8;
+    int page = y >= 0 ? y / 8 : -((7 - y) / 8);
+    int shift = y - page * 8;
+
+    for (int sp = 0; sp < src_pages; sp++, page++) {
+        const uint8_t *src = bitmap + (size_t)sp * w;
+        // Rows past h in the last source page are not part of the bitmap.
+        uint8_t valid = sp == src_pages - 1 && (h & 7) ? (uint8_t)(0xFF >> (8 - (h & 7))) : 0xFF;
+
+        // A source page lands on up to two framebuffer pages.
+        for (int half = 0; half < 2; half++) {
+            int dp = page + half;
+            if (dp < 0 || dp >= disp->pages || (half == 1 && shift == 0)) {
+                continue;
+            }
+            uint8_t *row = &disp->fb[dp][x + c0];
+            for (int c = c0; c < c1; c++, row++) {
+                uint8_t bits = src[c] & valid;
+                bits = half == 0 ? (uint8_t)(bits << shift) : (uint8_t)(bits >> (8 - shift));
+                uint8_t keep, flip;
+                ssd1306_color_masks(color, bits, &keep, &flip);
+                *row = (uint8_t)((*row & keep) ^ flip);
+            }
+            ssd1306_mark_dirty(disp, (uint8_t)dp, (uint8_t)(x + c0), (uint8_t)(x + c1 - 1));
+        }
+    }
+}
+
+// Private helper: transpose an 8x8 bit matrix held in a word, byte i bit j
+// to byte j bit i (Hacker's Delight 7-3): three rounds of swapping
+// off-diagonal 1x1, 2x2 and 4x4 blocks.
+static inline uint64_t ssd1306_transpose8(uint64_t x) {
+    uint64_t t;
+    t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+    x ^= t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+    x ^= t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+    x ^= t ^ (t << 28);
+    return x;
+}
+
+// Private helper: 8 pixels of a row-major bitmap row starting at column
+// col, leftmost pixel in bit 0. Pixels past the end of the row are 0.
+static inline uint8_t ssd1306_row_bits(const uint8_t *row, int col, int w, int lsb_first) {
+    int byte = col / 8, shift = col % 8;
+    unsigned v = row[byte];
+    if (shift && byte + 1 < (w + 7) / 8) {
+        v |= (unsigned)row[byte + 1] << 8;
+    }
+    if (!lsb_first) {
+        // Reverse each byte so that the leftmost pixel lands in bit 0.
+        v = ((v >> 1) & 0x5555) | ((v & 0x5555) << 1);
+        v = ((v >> 2) & 0x3333) | ((v & 0x3333) << 2);
+        v = ((v >> 4) & 0x0F0F) | ((v & 0x0F0F) << 4);
+    }
+    v >>= shift;
+    return (uint8_t)(col + 8 > w ? v & (0xFFu >> (col + 8 - w)) : v);
+}
+
+void ssd1306_draw_bitmap_rows(ssd1306_t *disp, int x, int y, const uint8_t *bits, int w, int h,
+                              size_t stride, int flags, int color) {
+    // Only the part on the panel is converted.
+    int c0 = x < 0 ? -x : 0, c1 = x + w > disp->geom.width ? disp->geom.width - x : w;
+    int r0 = y < 0 ? -y : 0, r1 = y + h > disp->geom.height ? disp->geom.height - y : h;
+    if (c0 >= c1 || r0 >= r1) {
+        return;
+    }
+    int cw = c1 - c0, ch = r1 - r0, lsb_first = flags & SSD1306_BITMAP_LSB_FIRST;
+
+    // Each 8x8 block is read as one word, row r in byte r, and transposed
+    // into 8 page bytes, column c in byte c.
+    uint8_t page_major[SSD1306_PAGES * SSD1306_WIDTH];
+    for (int sr = 0; sr < ch; sr += 8) {
+        uint8_t *out = page_major + (size_t)(sr / 8) * cw;
+        int nrows = ch - sr < 8 ? ch - sr : 8;
+        for (int sc = 0; sc < cw; sc += 8) {
+            uint64_t block = 0;
+            for (int r = 0; r < nrows; r++) {
+                const uint8_t *row = bits + (size_t)(r0 + sr + r) * stride;
+                block |= (uint64_t)ssd1306_row_bits(row, c0 + sc, c1, lsb_first) << (8 * r);
+            }
+            block = ssd1306_transpose8(block);
+            int ncols = cw - sc < 8 ? cw - sc : 8;
+            for (int c = 0; c < ncols; c++) {
+                out[sc + c] = (uint8_t)(block >> (8 * c));
+            }
+        }
+    }
+
+    if (flags & SSD1306_BITMAP_OPAQUE) {
+        ssd1306_blit_bitmap(disp, x + c0, y + r0, page_major, cw, ch);
+    } else {
+        ssd1306_draw_bitmap(disp, x + c0, y + r0, page_major, cw, ch, color);
+    }
+}
+
+void ssd1306_blit_bitmap(ssd1306_t *disp, int x, int y, const uint8_t *bitmap, int w, int h) {
+    int c0 = x < 0 ? -x : 0;
+    int c1 = x + w > disp->geom.width ? disp->geom.width - x : w;
+    if (w <= 0 || h <= 0 || c0 >= c1) {
+        return;
+    }
+
+    int src_pages = (h + 7) / 8;
+    int page = y >= 0 ? y / 8 : -((7 - y) / 8);
+    int shift = y - page * 8;
+
+    for (int sp = 0; sp < src_pages; sp++, page++) {
+        const uint8_t *src = bitmap + (size_t)sp * w;
+        uint8_t valid = sp == src_pages - 1 && (h & 7) ? (uint8_t)(0xFF >> (8 - (h & 7))) : 0xFF;
+
+        for (int half = 0; half < 2; half++) {
+            int dp = page + half;
+            if (dp < 0 || dp >= disp->pages || (half == 1 && shift == 0)) {
+                continue;
+            }
+            // The rows of this framebuffer page that the bitmap covers.
+            uint8_t cover = half == 0 ? (uint8_t)(valid << shift) : (uint8_t)(valid >> (8 - shift));
+            uint8_t *row = &disp->fb[dp][x + c0];
+            for (int c = c0; c < c1; c++, row++) {
+                uint8_t bits = half == 0 ? (uint8_t)(src[c] << shift) : (uint8_t)(src[c] >> (8 - shift));
+                *row = (uint8_t)((*row & ~cover) | (bits & cover));
+            }
+            ssd1306_mark_dirty(disp, (uint8_t)dp, (uint8_t)(x + c0), (uint8_t)(x + c1 - 1));
+        }
+    }
+}
@@ -0,0 +1,282 @@
+#include "ssd1306_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#define GRAY_MAX_BITS 3
+
+// Averages move by 1/8 of each new sample.
+#define EWMA(avg, sample) ((avg) = (avg) - ((avg) >> 3) + ((sample) >> 3))
+
+struct ssd1306_gray {
+    ssd1306_t *disp;
+    unsigned bits;
+    uint8_t planes[GRAY_MAX_BITS][SSD1306_PAGES][SSD1306_WIDTH]; // Bit k of each level, page-major.
+    uint8_t contrast[GRAY_MAX_BITS];   // Contrast each plane is shown at.
+    unsigned next;                     // Plane shown by the next step; cycles count down from the top.
+    atomic_int stop;
+    uint64_t plane_ns;                 // Time each plane is shown.
+    uint64_t switch_ns;                // Average cost of the slowest plane switch of a cycle.
+    uint64_t cycles, late;
+};
+
+ssd1306_gray_t *ssd1306_gray_create(ssd1306_t *disp, unsigned bits) {
+    if (bits < 2 || bits > GRAY_MAX_BITS) {
+        fprintf(stderr, "ssd1306: Grayscale takes 2 or 3 bits per pixel, not %u\n", bits);
+        return NULL;
+    }
+    if (disp->async || disp->client) {
+        // A skipped or coalesced plane would show the wrong gray.
+        fprintf(stderr, "ssd1306: Grayscale needs a display that flushes synchronously\n");
+        return NULL;
+    }
+    ssd1306_gray_t *g = calloc(1, sizeof(*g));
+    if (!g) {
+        perror("ssd1306: Failed to allocate grayscale planes");
+        return NULL;
+    }
+    g->disp = disp;
+    g->bits = bits;
+    g->next = bits - 1;
+    atomic_init(&g->stop, 0);
+
+    // Segment current follows the contrast setting, so halving it from one
+    // plane to the next weights the planes 4:2:1.
+    for (unsigned k = 0; k < bits; k++) {
+        g->contrast[k] = (uint8_t)(0xFF >> (bits - 1 - k));
+    }
+    return g;
+}
+
+void ssd1306_gray_destroy(ssd1306_gray_t *g) {
+    free(g);
+}
+
+void ssd1306_gray_set_contrast(ssd1306_gray_t *g, const uint8_t *contrast) {
+    memcpy(g->contrast, contrast, g->bits);
+}
+
+void ssd1306_gray_clear(ssd1306_gray_t *g) {
+    memset(g->planes, 0, sizeof(g->planes));
+}
+
+// Private helper: give the rows of mask in one page byte a level.
+static inline void ssd1306_gray_apply(ssd1306_gray_t *g, int page, int col, uint8_t mask, unsigned level) {
+    for (unsigned k = 0; k < g->bits; k++) {
+        uint8_t *b = &g->planes[k][page][col];
+        *b = (level >> k) & 1 ? (uint8_t)(*b | mask) : (uint8_t)(*b & ~mask);
+    }
+}
+
+void ssd1306_gray_set_pixel(ssd1306_gray_t *g, int x, int y, unsigned level) {
+    if (x < 0 || x >= g->disp->geom.width || y < 0 || y >= g->disp->geom.height) {
+        return;
+    }
+    ssd1306_gray_apply(g, y / 8, x, (uint8_t)(1 << (y % 8)), level);
+}
+
+unsigned ssd1306_gray_get_pixel(const ssd1306_gray_t *g, int x, int y) {
+    if (x < 0 || x >= g->disp->geom.width || y < 0 || y >= g->disp->geom.height) {
+        return 0;
+    }
+    unsigned level = 0;
+    for (unsigned k = 0; k < g->bits; k++) {
+        level |= (unsigned)((g->planes[k][y / 8][x] >> (y % 8)) & 1) << k;
+    }
+    return level;
+}
+
+void ssd1306_gray_fill_rect(ssd1306_gray_t *g, int x, int y, int w, int h, unsigned level) {
+    int x0 = x < 0 ? 0 : x, x1 = x + w > g->disp->geom.width ? g->disp->geom.width : x + w;
+    int y0 = y < 0 ? 0 : y, y1 = y + h > g->disp->geom.height ? g->disp->geom.height : y + h;
+    for (int page = y0 / 8; x0 < x1 && page * 8 < y1; page++) {
+        int top = y0 > page * 8 ? y0 - page * 8 : 0, bottom = y1 < page * 8 + 8 ? y1 - page * 8 : 8;
+        uint8_t mask = (uint8_t)((0xFF << top) & (0xFF >> (8 - bottom)));
+        for (int c = x0; c < x1; c++) {
+            ssd1306_gray_apply(g, page, c, mask, level);
+        }
+    }
+}
+
+void ssd1306_gray_draw_bitmap(ssd1306_gray_t *g, int x, int y, const uint8_t *bitmap, int w, int h,
+                              unsigned level) {
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    int c0 = x < 0 ? -x : 0;
+    int c1 = x + w > g->disp->geom.width ? g->disp->geom.width - x : w;
+    int src_pages = (h + 7) / 8;
+    int page = y >= 0 ? y / 8 : -((7 - y) / 8);
+    int shift = y - page * 8;
+
+    for (int sp = 0; sp < src_pages && c0 < c1; sp++, page++) {
+        const uint8_t *src = bitmap + (size_t)sp * w;
+        uint8_t valid = sp == src_pages - 1 && (h & 7) ? (uint8_t)(0xFF >> (8 - (h & 7))) : 0xFF;
+        for (int half = 0; half < 2; half++) {
+            int dp = page + half;
+            if (dp < 0 || dp >= g->disp->pages || (half == 1 && shift == 0)) {
+                continue;
+            }
+            for (int c = c0; c < c1; c++) {
+                uint8_t bits = src[c] & valid;
+                bits = half == 0 ? (uint8_t)(bits << shift) : (uint8_t)(bits >> (8 - shift));
+                ssd1306_gray_apply(g, dp, x + c, bits, level);
+            }
+        }
+    }
+}
+
+void ssd1306_gray_draw_image(ssd1306_gray_t *g, int x, int y, const uint8_t *gray, int w, int h, size_t stride) {
+    unsigned top = (1u << g->bits) - 1;
+    int x0 = x < 0 ? 0 : x, x1 = x + w > g->disp->geom.width ? g->disp->geom.width : x + w;
+    int y0 = y < 0 ? 0 : y, y1 = y + h > g->disp->geom.height ? g->disp->geom.height : y + h;
+
+    // Build each page byte of every plane at once from up to 8 source rows.
+    for (int page = y0 / 8; x0 < x1 && page * 8 < y1; page++) {
+        int r0 = y0 > page * 8 ? y0 - page * 8 : 0, r1 = y1 < page * 8 + 8 ? y1 - page * 8 : 8;
+        uint8_t mask = (uint8_t)((0xFF << r0) & (0xFF >> (8 - r1)));
+        for (int c = x0; c < x1; c++) {
+            uint8_t bits[GRAY_MAX_BITS] = { 0 };
+            for (int r = r0; r < r1; r++) {
+                unsigned level = (gray[(size_t)(page * 8 + r - y) * stride + (c - x)] * top + 127) / 255;
+                for (unsigned k = 0; k < g->bits; k++) {
+                    bits[k] |= (uint8_t)(((level >> k) & 1) << r);
+                }
+            }
+            for (unsigned k = 0; k < g->bits; k++) {
+                uint8_t *b = &g->planes[k][page][c];
+                *b = (uint8_t)((*b & ~mask) | bits[k]);
+            }
+        }
+    }
+}
+
+// Private helper: put plane k in the framebuffer, marking only the columns
+// where it differs from what the framebuffer (and so the panel) holds,
+// and send it together with its contrast.
+static int ssd1306_gray_show(ssd1306_gray_t *g, unsigned k, uint8_t contrast) {
+    ssd1306_t *disp = g->disp;
+    for (uint8_t page = 0; page < disp->pages; page++) {
+        const uint8_t *src = g->planes[k][page];
+        uint8_t *dst = disp->fb[page];
+        int lo = 0, hi = disp->geom.width - 1;
+        while (lo <= hi && src[lo] == dst[lo]) {
+            lo++;
+        }
+        while (hi > lo && src[hi] == dst[hi]) {
+            hi--;
+        }
+        if (lo <= hi) {
+            memcpy(dst + lo, src + lo, (size_t)(hi - lo + 1));
+            ssd1306_mark_dirty(disp, page, (uint8_t)lo, (uint8_t)hi);
+        }
+    }
+    ssd1306_set_contrast(disp, contrast);
+    return ssd1306_flush(disp);
+}
+
+int ssd1306_gray_step(ssd1306_gray_t *g) {
+    unsigned k = g->next;
+    g->next = k ? k - 1 : g->bits - 1;
+    return ssd1306_gray_show(g, k, g->contrast[k]);
+}
+
+void ssd1306_gray_stop(ssd1306_gray_t *g) {
+    atomic_store(&g->stop, 1);
+}
+
+// Private helper: sleep until a CLOCK_MONOTONIC time, or until stopped.
+static void ssd1306_gray_sleep(ssd1306_gray_t *g, uint64_t until_ns) {
+    struct timespec ts = { .tv_sec = (time_t)(until_ns / 1000000000ULL), .tv_nsec = (long)(until_ns % 1000000000ULL) };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR && !atomic_load(&g->stop)) {
+    }
+}
+
+int ssd1306_gray_run(ssd1306_gray_t *g, unsigned hz, ssd1306_gray_fn update, void *arg) {
+    if (hz == 0) {
+        fprintf(stderr, "ssd1306: Grayscale cycle rate must be at least 1 Hz\n");
+        return -1;
+    }
+    atomic_store(&g->stop, 0);
+    uint8_t contrast = ssd1306_get_contrast(g->disp);
+    uint64_t target_ns = 1000000000ULL / (hz * g->bits), worst = 0;
+    if (g->plane_ns < target_ns) {
+        g->plane_ns = target_ns;
+    }
+    uint64_t slot = ssd1306_now_ns();
+    int ret = 0;
+
+    while (!atomic_load(&g->stop)) {
+        // Planes only change between cycles, so no cycle mixes two images.
+        if (g->next == g->bits - 1 && update && (ret = update(g, arg)) != 0) {
+            break;
+        }
+        ssd1306_gray_sleep(g, slot);
+        if (atomic_load(&g->stop)) {
+            break;
+        }
+        uint64_t t0 = ssd1306_now_ns();
+        if (ssd1306_gray_step(g) < 0) {
+            ret = -1;
+            break;
+        }
+        uint64_t t1 = ssd1306_now_ns();
+        worst = t1 - t0 > worst ? t1 - t0 : worst;
+        g->late += t1 > slot + g->plane_ns;
+
+        // Every plane must be shown for the same time, so the slot is set by
+        // the slowest switch: it stretches as soon as a cycle overruns and
+        // shrinks back towards the target as switches get cheaper.
+        if (g->next == g->bits - 1) {
+            if (g->switch_ns == 0) {
+                g->switch_ns = worst;
+            } else {
+                EWMA(g->switch_ns, worst);
+            }
+            uint64_t need = (worst > g->switch_ns ? worst : g->switch_ns) * 11 / 10;
+            g->plane_ns = need > target_ns ? need : target_ns;
+            g->cycles++;
+            worst = 0;
+        }
+
+        // A late slot is not made up for; the next plane gets its full time.
+        slot += g->plane_ns;
+        if (slot < t1) {
+            slot = t1;
+        }
+    }
+
+    // Leave the top plane on the panel at the contrast it had before.
+    g->next = g->bits - 1;
+    if (ssd1306_gray_show(g, g->bits - 1, contrast) < 0 && ret == 0) {
+        ret = -1;
+    }
+    return ret;
+}
+
+void ssd1306_gray_info(const ssd1306_gray_t *g, ssd1306_gray_info_t *info) {
+    info->bits = g->bits;
+    info->hz = g->plane_ns ? (unsigned)(1000000000ULL / (g->plane_ns * g->bits)) : 0;
+    info->plane_ns = g->plane_ns;
+    info->switch_ns = g->switch_ns;
+    info->cycles = g->cycles;
+    info->late = g->late;
+
+    // The deepest cycle whose planes fit a flicker-free period at the
+    // measured switch cost, with the same margin the loop keeps. One plane
+    // needs no cycling at all.
+    info->sustainable_bits = 0;
+    if (g->switch_ns) {
+        uint64_t period = 1000000000ULL / SSD1306_GRAY_MIN_HZ;
+        info->sustainable_bits = 1;
+        for (unsigned bits = GRAY_MAX_BITS; bits > 1; bits--) {
+            if (bits * g->switch_ns * 11 / 10 <= period) {
+                info->sustainable_bits = bits;
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,261 @@
+#include "ssd1306_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include <sys/ioctl.h>
+#include <string.h>
+
+// i2c-dev rejects messages longer than this, for both write() and I2C_RDWR.
+#define I2C_DEV_MAX_MSG 8192
+
+// Smallest message size we shrink to when an adapter rejects long messages:
+// an SMBus block (32 bytes) plus the control byte.
+#define I2C_MIN_MSG 33
+
+// Bus clock assumed when the device tree does not say.
+#define I2C_DEFAULT_HZ 400000
+
+typedef struct {
+    int fd;
+    char *dev;        // Device path, which names the bus.
+    uint32_t bus_hz;  // SCL frequency.
+    uint16_t addr;
+    char addr_id[8];  // addr as "0x3c".
+    int use_rdwr;     // 0 when the adapter only supports plain write().
+    size_t max_msg;   // Largest message (control byte included) the adapter accepts.
+    uint8_t *stage;   // Staging area for control byte + payload of each message.
+    size_t stage_cap;
+    ssd1306_bus_stats_t counters;
+} ssd1306_i2c_t;
+
+static void ssd1306_i2c_close(void *ctx) {
+    ssd1306_i2c_t *bus = ctx;
+    if (bus->fd >= 0) {
+        close(bus->fd);
+    }
+    free(bus->stage);
+    free(bus->dev);
+    free(bus);
+}
+
+static const char *ssd1306_i2c_bus_id(void *ctx) {
+    return ((ssd1306_i2c_t *)ctx)->dev;
+}
+
+static const char *ssd1306_i2c_dev_id(void *ctx) {
+    return ((ssd1306_i2c_t *)ctx)->addr_id;
+}
+
+static void ssd1306_i2c_stats(void *ctx, ssd1306_bus_stats_t *stats) {
+    *stats = ((ssd1306_i2c_t *)ctx)->counters;
+}
+
+static void ssd1306_i2c_cost(void *ctx, ssd1306_cost_t *cost) {
+    ssd1306_i2c_t *bus = ctx;
+    // 9 clocks per byte (8 bits and ACK). A message adds about 20 more for
+    // the start condition, the address byte and the control byte.
+    cost->xfer_ns = 30000;
+    cost->seg_ns = (uint32_t)(20 * 1000000000ULL / bus->bus_hz);
+    cost->byte_ns = (uint32_t)(9 * 1000000000ULL / bus->bus_hz);
+}
+
+// Private helper: the bus clock from the device tree node of /dev/i2c-N.
+static uint32_t ssd1306_i2c_bus_hz(const char *dev) {
+    const char *name = strrchr(dev, '/');
+    char path[128];
+    uint8_t be[4];
+    uint32_t hz = I2C_DEFAULT_HZ;
+
+    snprintf(path, sizeof(path), "/sys/class/i2c-dev/%s/device/of_node/clock-frequency",
+             name ? name + 1 : dev);
+    FILE *fp = fopen(path, "rb");
+    if (fp) {
+        if (fread(be, 1, sizeof(be), fp) == sizeof(be)) {
+            uint32_t v = (uint32_t)be[0] << 24 | (uint32_t)be[1] << 16 | (uint32_t)be[2] << 8 | be[3];
+            if (v > 0) {
+                hz = v;
+            }
+        }
+        fclose(fp);
+    }
+    return hz;
+}
+
+static void ssd1306_i2c_set_max_transfer(void *ctx, size_t bytes) {
+    ssd1306_i2c_t *bus = ctx;
+    if (bytes >= 2 && bytes < bus->max_msg) {
+        bus->max_msg = bytes;
+    }
+}
+
+// Private helper: make sure the staging area holds at least len bytes.
+static int ssd1306_i2c_reserve(ssd1306_i2c_t *bus, size_t len) {
+    if (len <= bus->stage_cap) {
+        return 0;
+    }
+    uint8_t *stage = realloc(bus->stage, len);
+    if (!stage) {
+        perror("ssd1306: Failed to allocate transfer buffer");
+        return -1;
+    }
+    bus->stage = stage;
+    bus->stage_cap = len;
+    return 0;
+}
+
+// Private helper: send messages one write() at a time, for adapters without
+// I2C_RDWR. Returns the number of messages sent in full, or -1 on error.
+static int ssd1306_i2c_write_msgs(ssd1306_i2c_t *bus, const struct i2c_msg *msgs, size_t nmsgs) {
+    for (size_t i = 0; i < nmsgs; i++) {
+        ssize_t n = write(bus->fd, msgs[i].buf, msgs[i].len);
+        if (n < 0) {
+            return -1;
+        }
+        if (n != (ssize_t)msgs[i].len) {
+            return (int)i;
+        }
+    }
+    return (int)nmsgs;
+}
+
+static int ssd1306_i2c_xfer(void *ctx, const ssd1306_seg_t *segs, size_t nsegs) {
+    ssd1306_i2c_t *bus = ctx;
+    size_t seg = 0, off = 0;
+
+    while (seg < nsegs) {
+        struct i2c_msg msgs[I2C_RDWR_IOCTL_MAX_MSGS];
+        size_t chunk = bus->max_msg - 1; // Payload bytes per message.
+        size_t nmsgs = 0, used = 0;
+        size_t next_seg = seg, next_off = off;
+
+        // Size the staging area for everything that is left at this chunk size,
+        // so the message pointers below stay valid while the batch is built.
+        size_t need = 0;
+        for (size_t i = seg; i < nsegs; i++) {
+            size_t len = segs[i].len - (i == seg ? off : 0);
+            need += len + (len + chunk - 1) / chunk;
+        }
+        if (ssd1306_i2c_reserve(bus, need) < 0) {
+            return -1;
+        }
+
+        // Build one batch: up to I2C_RDWR_IOCTL_MAX_MSGS messages, each a
+        // control byte followed by at most one chunk of a segment.
+        while (next_seg < nsegs && nmsgs < I2C_RDWR_IOCTL_MAX_MSGS) {
+            const ssd1306_seg_t *s = &segs[next_seg];
+            size_t len = s->len - next_off;
+            if (len > chunk) {
+                len = chunk;
+            }
+            if (len > 0) {
+                uint8_t *buf = bus->stage + used;
+                buf[0] = s->ctrl;
+                memcpy(&buf[1], s->buf + next_off, len);
+                msgs[nmsgs].addr = bus->addr;
+                msgs[nmsgs].flags = 0;
+                msgs[nmsgs].len = (uint16_t)(len + 1);
+                msgs[nmsgs].buf = buf;
+                nmsgs++;
+                used += len + 1;
+                next_off += len;
+            }
+            if (next_off >= s->len) {
+                next_seg++;
+                next_off = 0;
+            }
+        }
+
+        if (nmsgs > 0) {
+            int ret;
+            if (bus->use_rdwr) {
+                struct i2c_rdwr_ioctl_data xfer = { msgs, (uint32_t)nmsgs };
+                ret = ioctl(bus->fd, I2C_RDWR, &xfer);
+            } else {
+                ret = ssd1306_i2c_write_msgs(bus, msgs, nmsgs);
+            }
+            if (ret < 0) {
+                if (bus->use_rdwr && errno == ENOTTY) {
+                    // The driver has no I2C_RDWR: resend this batch with write().
+                    bus->use_rdwr = 0;
+                    bus->counters.retries++;
+                    continue;
+                }
+                if ((errno == EINVAL || errno == EOPNOTSUPP) && bus->max_msg > I2C_MIN_MSG) {
+                    // The adapter rejected the message length before anything
+                    // went out on the wire: shrink and rebuild this batch.
+                    bus->max_msg = bus->max_msg / 2 > I2C_MIN_MSG ? bus->max_msg / 2 : I2C_MIN_MSG;
+                    bus->counters.retries++;
+                    continue;
+                }
+                perror("ssd1306: I2C transfer failed");
+                return -1;
+            }
+            if ((size_t)ret < nmsgs) {
+                // The panel stopped acknowledging part way: what it got is
+                // unknown, so the frame is failed and its dirty columns are
+                // sent again without diffing against the shadow.
+                bus->counters.short_writes++;
+                fprintf(stderr, "ssd1306: I2C transfer cut short after %d of %zu messages\n", ret, nmsgs);
+                return -1;
+            }
+        }
+        seg = next_seg;
+        off = next_off;
+    }
+    return 0;
+}
+
+static const ssd1306_transport_ops_t ssd1306_i2c_ops = {
+    .name = "i2c",
+    .xfer = ssd1306_i2c_xfer,
+    .set_max_transfer = ssd1306_i2c_set_max_transfer,
+    .close = ssd1306_i2c_close,
+    .bus_id = ssd1306_i2c_bus_id,
+    .cost = ssd1306_i2c_cost,
+    .stats = ssd1306_i2c_stats,
+    .dev_id = ssd1306_i2c_dev_id,
+};
+
+// Private helper: open the I2C transport of a panel. Returns NULL on error.
+static ssd1306_i2c_t *ssd1306_i2c_open(const char *i2c_dev, uint8_t address) {
+    ssd1306_i2c_t *bus = calloc(1, sizeof(*bus));
+    if (!bus) {
+        perror("ssd1306: Failed to allocate I2C transport");
+        return NULL;
+    }
+    bus->fd = open(i2c_dev, O_RDWR);
+    if (bus->fd < 0) {
+        perror("ssd1306: Failed to open I2C device");
+        free(bus);
+        return NULL;
+    }
+    // The slave address is still needed for the plain write() fallback.
+    if (ioctl(bus->fd, I2C_SLAVE, address) < 0) {
+        perror("ssd1306: Failed to acquire bus access");
+        ssd1306_i2c_close(bus);
+        return NULL;
+    }
+    unsigned long funcs = 0;
+    bus->dev = strdup(i2c_dev);
+    bus->bus_hz = ssd1306_i2c_bus_hz(i2c_dev);
+    bus->addr = address;
+    snprintf(bus->addr_id, sizeof(bus->addr_id), "0x%02x", address);
+    bus->use_rdwr = ioctl(bus->fd, I2C_FUNCS, &funcs) == 0 && (funcs & I2C_FUNC_I2C);
+    bus->max_msg = I2C_DEV_MAX_MSG;
+    return bus;
+}
+
+ssd1306_t *ssd1306_init(const char *i2c_dev, uint8_t address) {
+    ssd1306_i2c_t *bus = ssd1306_i2c_open(i2c_dev, address);
+    return bus ? ssd1306_init_transport(&ssd1306_i2c_ops, bus) : NULL;
+}
+
+ssd1306_t *ssd1306_attach(const char *i2c_dev, uint8_t address, const ssd1306_geometry_t *geom,
+                          const char *state_path) {
+    ssd1306_i2c_t *bus = ssd1306_i2c_open(i2c_dev, address);
+    return bus ? ssd1306_attach_transport(&ssd1306_i2c_ops, bus, geom, state_path) : NULL;
+}
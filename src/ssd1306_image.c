@@ -0,0 +1,160 @@
+#include "ssd1306_internal.h"
+#include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// 8x8 Bayer matrix: the order in which pixels of a tile turn on as gray rises.
+static const uint8_t bayer8[8][8] = {
+    {  0, 32,  8, 40,  2, 34, 10, 42 },
+    { 48, 16, 56, 24, 50, 18, 58, 26 },
+    { 12, 44,  4, 36, 14, 46,  6, 38 },
+    { 60, 28, 52, 20, 62, 30, 54, 22 },
+    {  3, 35, 11, 43,  1, 33,  9, 41 },
+    { 51, 19, 59, 27, 49, 17, 57, 25 },
+    { 15, 47,  7, 39, 13, 45,  5, 37 },
+    { 63, 31, 55, 23, 61, 29, 53, 21 },
+};
+
+// Private helper: scale a grayscale image to w x h by averaging the source
+// pixels under each destination pixel (repeating them when enlarging).
+static void ssd1306_gray_resize(const uint8_t *src, int sw, int sh, size_t stride,
+                                uint8_t *dst, int w, int h) {
+    if (sw == w && sh == h) {
+        for (int y = 0; y < h; y++) {
+            memcpy(dst + (size_t)y * w, src + (size_t)y * stride, (size_t)w);
+        }
+        return;
+    }
+    uint16_t x0[SSD1306_WIDTH], x1[SSD1306_WIDTH];
+    for (int x = 0; x < w; x++) {
+        x0[x] = (uint16_t)((long)x * sw / w);
+        x1[x] = (uint16_t)((long)(x + 1) * sw / w);
+        if (x1[x] <= x0[x]) {
+            x1[x] = x0[x] + 1;
+        }
+    }
+    uint32_t sums[SSD1306_WIDTH];
+    for (int y = 0; y < h; y++) {
+        int y0 = (int)((long)y * sh / h), y1 = (int)((long)(y + 1) * sh / h);
+        if (y1 <= y0) {
+            y1 = y0 + 1;
+        }
+        memset(sums, 0, sizeof(uint32_t) * (size_t)w);
+        for (int sy = y0; sy < y1; sy++) {
+            const uint8_t *row = src + (size_t)sy * stride;
+            for (int x = 0; x < w; x++) {
+                uint32_t s = 0;
+                for (int sx = x0[x]; sx < x1[x]; sx++) {
+                    s += row[sx];
+                }
+                sums[x] += s;
+            }
+        }
+        uint8_t *out = dst + (size_t)y * w;
+        for (int x = 0; x < w; x++) {
+            uint32_t n = (uint32_t)(x1[x] - x0[x]) * (uint32_t)(y1 - y0);
+            out[x] = (uint8_t)((sums[x] + n / 2) / n);
+        }
+    }
+}
+
+// Private helper: Floyd-Steinberg error diffusion, in place, to 0 or 255.
+// Rows alternate direction so the error does not drift one way.
+static void ssd1306_gray_diffuse(uint8_t *img, int w, int h) {
+    int16_t err[2][SSD1306_WIDTH + 2];
+    memset(err, 0, sizeof(err));
+    for (int y = 0; y < h; y++) {
+        int16_t *cur = err[y & 1] + 1, *next = err[~y & 1] + 1;
+        memset(next - 1, 0, sizeof(err[0]));
+        uint8_t *row = img + (size_t)y * w;
+        int dir = y & 1 ? -1 : 1;
+        for (int i = 0, x = dir > 0 ? 0 : w - 1; i < w; i++, x += dir) {
+            int v = row[x] + cur[x];
+            int out = v >= 128 ? 255 : 0;
+            int e = v - out, e7 = e * 7 / 16, e3 = e * 3 / 16, e5 = e * 5 / 16;
+            row[x] = (uint8_t)out;
+            // The last share takes the rounding, so no error is lost.
+            cur[x + dir] += (int16_t)e7;
+            next[x - dir] += (int16_t)e3;
+            next[x] += (int16_t)e5;
+            next[x + dir] += (int16_t)(e - e7 - e3 - e5);
+        }
+    }
+}
+
+// Private helper: pack up to 8 rows of w pixels into w page bytes. Bit r of
+// byte c is set where row r is at least its threshold at column c. Comparing
+// 16 columns at a time yields 0xFF/0x00 lanes; masking each row's lanes
+// with its bit and ORing them builds the page bytes directly, with no
+// transpose.
+static void ssd1306_gray_pack(const uint8_t *rows, int w, int nrows, const uint8_t *const *thr, uint8_t *out) {
+    int c = 0;
+#if defined(__SSE2__)
+    for (; c + 16 <= w; c += 16) {
+        __m128i acc = _mm_setzero_si128();
+        for (int r = 0; r < nrows; r++) {
+            __m128i v = _mm_loadu_si128((const __m128i *)(rows + (size_t)r * w + c));
+            __m128i t = _mm_loadu_si128((const __m128i *)(thr[r] + c));
+            __m128i on = _mm_cmpeq_epi8(_mm_max_epu8(v, t), v);
+            acc = _mm_or_si128(acc, _mm_and_si128(on, _mm_set1_epi8((char)(1 << r))));
+        }
+        _mm_storeu_si128((__m128i *)(out + c), acc);
+    }
+#elif defined(__ARM_NEON)
+    for (; c + 16 <= w; c += 16) {
+        uint8x16_t acc = vdupq_n_u8(0);
+        for (int r = 0; r < nrows; r++) {
+            uint8x16_t on = vcgeq_u8(vld1q_u8(rows + (size_t)r * w + c), vld1q_u8(thr[r] + c));
+            acc = vorrq_u8(acc, vandq_u8(on, vdupq_n_u8((uint8_t)(1 << r))));
+        }
+        vst1q_u8(out + c, acc);
+    }
+#endif
+    for (; c < w; c++) {
+        uint8_t bits = 0;
+        for (int r = 0; r < nrows; r++) {
+            bits |= (uint8_t)((rows[(size_t)r * w + c] >= thr[r][c]) << r);
+        }
+        out[c] = bits;
+    }
+}
+
+int ssd1306_draw_gray(ssd1306_t *disp, int x, int y, int w, int h,
+                      const uint8_t *gray, int sw, int sh, size_t stride, int dither) {
+    if (w <= 0 || h <= 0 || w > SSD1306_WIDTH || h > SSD1306_HEIGHT || sw <= 0 || sh <= 0 ||
+        stride < (size_t)sw) {
+        return -1;
+    }
+    uint8_t img[SSD1306_HEIGHT * SSD1306_WIDTH];
+    ssd1306_gray_resize(gray, sw, sh, stride, img, w, h);
+
+    // Per-row thresholds: mid-gray, or a row of the Bayer matrix tiled
+    // across the panel, anchored to panel coordinates so that a moving
+    // image does not drag the pattern along.
+    uint8_t mid[SSD1306_WIDTH], tiles[8][SSD1306_WIDTH];
+    memset(mid, 128, sizeof(mid));
+    if (dither == SSD1306_DITHER_BAYER) {
+        for (int r = 0; r < 8; r++) {
+            for (int c = 0; c < w; c++) {
+                tiles[r][c] = (uint8_t)(bayer8[(y + r) & 7][(x + c) & 7] * 4 + 2);
+            }
+        }
+    } else if (dither == SSD1306_DITHER_FLOYD) {
+        ssd1306_gray_diffuse(img, w, h);
+    }
+
+    uint8_t bitmap[SSD1306_PAGES * SSD1306_WIDTH];
+    for (int page = 0; page * 8 < h; page++) {
+        const uint8_t *thr[8];
+        for (int r = 0; r < 8; r++) {
+            thr[r] = dither == SSD1306_DITHER_BAYER ? tiles[r] : mid;
+        }
+        int nrows = h - page * 8 < 8 ? h - page * 8 : 8;
+        ssd1306_gray_pack(img + (size_t)page * 8 * w, w, nrows, thr, bitmap + (size_t)page * w);
+    }
+    ssd1306_blit_bitmap(disp, x, y, bitmap, w, h);
+    return 0;
+}
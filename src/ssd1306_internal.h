@@ -0,0 +1,198 @@
+#ifndef SSD1306_INTERNAL_H
+#define SSD1306_INTERNAL_H
+
+#include "ssd1306.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <time.h>
+
+// Marks a page with no dirty columns.
+#define DIRTY_NONE 0xFF
+
+// Panel refresh rate with the init sequence's oscillator (0xD5 0x80, about
+// 370 kHz), pre-charge (0xD9 0xF1: 1 + 15 + 50 clocks per row) and 64 MUX:
+// 370000 / (66 * 64). Hardware scroll speeds are whole fractions of it.
+#define PANEL_FRAME_HZ 88
+
+// Text runs (ssd1306_text.c): the longest run rendered and cached in one
+// piece, and how many recent runs are kept per display.
+#define TEXT_RUN_CHARS  (SSD1306_WIDTH / 6)
+#define TEXT_CACHE_SIZE 8
+
+typedef struct {
+    char str[TEXT_RUN_CHARS];
+    uint8_t len;                       // Characters in str; 0 marks an empty slot.
+    uint32_t used;                     // Last use, for least-recently-used replacement.
+    uint8_t cols[TEXT_RUN_CHARS * 6];  // Rendered columns, spacing included.
+} ssd1306_text_run_t;
+
+// Frame encoding (ssd1306_encode.c): most changed spans kept per page before
+// the rest of the page is sent as one, and room for the whole transfer.
+#define ENC_SPANS_PER_PAGE 8
+#define ENC_MAX_SEGS       (2 * SSD1306_PAGES * ENC_SPANS_PER_PAGE + 4)
+#define ENC_CMD_BYTES      (3 * SSD1306_PAGES * ENC_SPANS_PER_PAGE + 64)
+
+// One transfer being built: segments plus the storage they point into.
+typedef struct {
+    ssd1306_seg_t segs[ENC_MAX_SEGS];
+    size_t nsegs;
+    uint8_t cmds[ENC_CMD_BYTES];
+    size_t ncmds;
+    uint8_t stage[SSD1306_PAGES * SSD1306_WIDTH]; // Window data narrower than the panel.
+    uint8_t lo[SSD1306_PAGES], hi[SSD1306_PAGES]; // Changed extent per page, or DIRTY_NONE.
+    uint8_t window[4];                            // Address window after the transfer.
+    ssd1306_flush_report_t report;
+} ssd1306_enc_t;
+
+// Frame update latency histogram (ssd1306_stats.c): four buckets per power
+// of two microseconds, enough for any 32-bit latency.
+#define LATENCY_BUCKETS 128
+
+/*
+ * Display server protocol (ssd1306_server.c, ssd1306_client.c)
+ *
+ * Clients talk to the server over a SOCK_SEQPACKET Unix socket. A client
+ * attaches a sealed memfd holding one layer and then sends an update
+ * whenever it has published a new frame into it.
+ */
+
+#define MSG_ATTACH  1   // Client: attach the memfd passed along (SCM_RIGHTS) at z.
+#define MSG_UPDATE  2   // Client: the layer holds a new frame.
+#define MSG_WELCOME 3   // Server: reply to MSG_ATTACH, with the panel geometry.
+
+typedef struct {
+    uint8_t type;                      // MSG_*.
+    int8_t status;                     // MSG_WELCOME: 0, or -1 if the layer was refused.
+    int16_t z;                         // MSG_ATTACH: stacking order, higher on top.
+    ssd1306_geometry_t geom;           // MSG_WELCOME.
+} ssd1306_msg_t;
+
+// A layer as the client publishes it, in screen rows (the client's start
+// line already applied). seq is odd while the client writes, so the server
+// can tell a torn copy from a complete one.
+typedef struct {
+    _Atomic uint32_t seq;
+    uint8_t pixels[SSD1306_PAGES * SSD1306_WIDTH];
+    uint8_t mask[SSD1306_PAGES * SSD1306_WIDTH];   // Set bits cover the layers below.
+} ssd1306_layer_shm_t;
+
+/*
+ * Display state
+ */
+
+// Controller registers that travel with each frame. ssd1306_flush_frame()
+// brings the panel from its current view to the frame's one around the
+// frame data.
+typedef struct {
+    uint8_t start_line;                // Display start line.
+    uint8_t contrast;                  // Contrast control (0x81).
+    ssd1306_scroll_t scroll;           // Hardware scroll, all zero when off.
+    uint8_t hshift;                    // Columns the content has moved right, mod 256.
+} ssd1306_view_t;
+
+struct ssd1306 {
+    const ssd1306_transport_ops_t *ops;
+    void *ctx;                                    // Transport state, owned by the display.
+    pthread_mutex_t xfer_lock;                    // Serializes transfers across threads.
+    ssd1306_bus_stats_t bus_seen;                 // Transport counters already counted (xfer_lock).
+    int ram_uncertain;                            // A transfer failed since the last full repaint (xfer_lock).
+    int warm;                                     // Attached to a panel left running, without init.
+    struct ssd1306_async *async;                  // Flush worker, or NULL when synchronous.
+    struct ssd1306_client *client;                // Server connection of a client display, or NULL.
+    ssd1306_geometry_t geom;                      // Visible part of panel RAM.
+    uint8_t pages;                                // geom.height / 8.
+    uint8_t fb[SSD1306_PAGES][SSD1306_WIDTH];     // What the application draws.
+    uint8_t shadow[SSD1306_PAGES][SSD1306_WIDTH]; // What the panel currently shows.
+    int shadow_valid;                             // 0 until the first full flush and after a failed one.
+    uint8_t dirty_lo[SSD1306_PAGES];              // First modified column, or DIRTY_NONE.
+    uint8_t dirty_hi[SSD1306_PAGES];              // Last modified column.
+    uint8_t page, col;                            // Text cursor.
+    ssd1306_view_t view;                          // Controller state the application wants.
+    ssd1306_view_t panel_view;                    // Controller state the panel uses.
+    uint8_t window[4];                            // Address window in panel coordinates: first/last column, first/last page.
+    uint8_t content_scroll;                       // Controller takes 0x2C/0x2D one-column shifts.
+    uint64_t shift_ns;                            // Time of the last one.
+    ssd1306_cost_t cost;                          // Bus cost model of the transport.
+    pthread_mutex_t stats_lock;                   // Guards the fields below; never held during a transfer.
+    ssd1306_flush_report_t report;                // Last flush that reached the panel.
+    ssd1306_stats_t stats;                        // Counters; the latency fields are computed on snapshot.
+    uint32_t latency[LATENCY_BUCKETS];            // Frame update latency histogram.
+    uint32_t latency_max_us;
+    FILE *trace;                                  // Chrome trace output, or NULL.
+    size_t trace_events;
+    unsigned console_step_us;                     // Console scroll delay per pixel; 0 scrolls by whole lines.
+    ssd1306_text_run_t text_cache[TEXT_CACHE_SIZE];
+    uint32_t text_clock;
+};
+
+static inline uint64_t ssd1306_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Allocate a display on a transport without talking to the panel, and
+// bring the panel up from reset with the init sequence and a blank frame
+// (ssd1306.c). ssd1306_alloc() closes the transport if it fails.
+ssd1306_t *ssd1306_alloc(const ssd1306_transport_ops_t *ops, void *ctx);
+int ssd1306_cold_init(ssd1306_t *disp);
+
+// Send segments through the display's transport, and count and trace the
+// transfer (ssd1306_stats.c). Returns 0 on success, -1 on error.
+int ssd1306_xfer(ssd1306_t *disp, const ssd1306_seg_t *segs, size_t nsegs);
+
+// Account for a frame update that started at t0_ns and ended in result
+// (0 or -1). Also records the report of updates that reached the panel.
+void ssd1306_stats_frame(ssd1306_t *disp, const ssd1306_flush_report_t *report, int result, uint64_t t0_ns);
+
+// Application-side events: a call to ssd1306_flush(), or a published frame
+// that replaced one the async worker had not sent yet.
+#define STATS_FLUSH 0
+#define STATS_DROP  1
+void ssd1306_stats_event(ssd1306_t *disp, int event);
+
+// Send the dirty column ranges of a page-major frame, trimmed against the
+// shadow, and update the shadow. View changes go out in the same transfer.
+// Returns 0 on success, -1 on error.
+int ssd1306_flush_frame(ssd1306_t *disp, const uint8_t *frame, const ssd1306_view_t *view,
+                        const uint8_t *dirty_lo, const uint8_t *dirty_hi);
+
+// Start an empty transfer, then append command or data bytes to it. Data
+// that continues the previous data segment in memory extends it.
+void ssd1306_enc_init(ssd1306_enc_t *enc, const uint8_t *window);
+void ssd1306_enc_cmd(ssd1306_enc_t *enc, const uint8_t *cmds, size_t n);
+void ssd1306_enc_data(ssd1306_enc_t *enc, const uint8_t *data, size_t n);
+
+// Append the dirty ranges of a page-major frame, diffed against the shadow,
+// in the cheapest encoding for the display's cost model. Frozen pages are
+// skipped and repaint pages are sent whole.
+void ssd1306_encode(const ssd1306_t *disp, const uint8_t *frame,
+                    const uint8_t *dirty_lo, const uint8_t *dirty_hi,
+                    uint8_t frozen, uint8_t repaint, ssd1306_enc_t *enc);
+
+// Pages whose RAM a running hardware scroll moves, as a bitmask, and the
+// commands that start or stop it (ssd1306_scroll.c).
+uint8_t ssd1306_scroll_pages(const ssd1306_scroll_t *scroll);
+void ssd1306_scroll_commands(const ssd1306_t *disp, ssd1306_cmdbuf_t *cb, const ssd1306_scroll_t *scroll);
+
+// Write an 8-pixel-tall strip of n column bytes with its top-left corner at
+// pixel (x, y), clipped to the panel. The strip straddles two pages unless
+// y is page-aligned (ssd1306_text.c).
+void ssd1306_blit_strip(ssd1306_t *disp, int x, int y, const uint8_t *cols, size_t n);
+
+// Glyph index of a character, or -1 if the font lacks it. Characters
+// outside the font fall back to '?', then to nothing (ssd1306_font.c).
+int ssd1306_glyph_index(const ssd1306_font_t *font, char ch);
+
+// Copy a w x h page-major bitmap to (x, y), clipped to the panel: unlike
+// ssd1306_draw_bitmap(), clear bits clear pixels (ssd1306_gfx.c).
+void ssd1306_blit_bitmap(ssd1306_t *disp, int x, int y, const uint8_t *bitmap, int w, int h);
+
+// Publish the framebuffer to the flush worker (ssd1306_async.c).
+int ssd1306_async_present(ssd1306_t *disp);
+
+// Publish the framebuffer to the display server (ssd1306_client.c).
+int ssd1306_client_present(ssd1306_t *disp);
+
+#endif // SSD1306_INTERNAL_H
@@ -0,0 +1,227 @@
+#include "ssd1306_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Completion state shared by the jobs of one ssd1306_mgr_flush() call.
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t done;
+    size_t pending;
+    int failed;
+} ssd1306_mgr_group_t;
+
+// One display flush queued on a bus worker.
+typedef struct ssd1306_mgr_job {
+    ssd1306_t *disp;
+    ssd1306_mgr_group_t *group;
+    struct ssd1306_mgr_job *next;
+} ssd1306_mgr_job_t;
+
+// One physical bus and the worker thread that owns it. Jobs are served
+// first-come first-served, so displays sharing the bus take turns.
+typedef struct {
+    char *id;                   // NULL for transports that do not share a bus.
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    ssd1306_mgr_job_t *head, *tail;
+    int stop;
+} ssd1306_mgr_bus_t;
+
+typedef struct {
+    ssd1306_t *disp;
+    ssd1306_mgr_bus_t *bus;
+} ssd1306_mgr_entry_t;
+
+struct ssd1306_mgr {
+    ssd1306_mgr_entry_t *entries;
+    size_t nentries;
+    ssd1306_mgr_bus_t **buses;
+    size_t nbuses;
+};
+
+static void *ssd1306_mgr_worker(void *arg) {
+    ssd1306_mgr_bus_t *bus = arg;
+
+    pthread_mutex_lock(&bus->lock);
+    for (;;) {
+        while (!bus->head && !bus->stop) {
+            pthread_cond_wait(&bus->wake, &bus->lock);
+        }
+        if (!bus->head) {
+            break;
+        }
+        ssd1306_mgr_job_t *job = bus->head;
+        bus->head = job->next;
+        if (!bus->head) {
+            bus->tail = NULL;
+        }
+        pthread_mutex_unlock(&bus->lock);
+
+        int ret = ssd1306_flush(job->disp);
+
+        ssd1306_mgr_group_t *group = job->group;
+        pthread_mutex_lock(&group->lock);
+        if (ret < 0) {
+            group->failed = 1;
+        }
+        if (--group->pending == 0) {
+            pthread_cond_signal(&group->done);
+        }
+        pthread_mutex_unlock(&group->lock);
+
+        pthread_mutex_lock(&bus->lock);
+    }
+    pthread_mutex_unlock(&bus->lock);
+    return NULL;
+}
+
+ssd1306_mgr_t *ssd1306_mgr_create(void) {
+    ssd1306_mgr_t *mgr = calloc(1, sizeof(*mgr));
+    if (!mgr) {
+        perror("ssd1306: Failed to allocate display manager");
+    }
+    return mgr;
+}
+
+// Private helper: find the worker for a bus id, starting one if needed.
+static ssd1306_mgr_bus_t *ssd1306_mgr_bus(ssd1306_mgr_t *mgr, const char *id) {
+    if (id) {
+        for (size_t i = 0; i < mgr->nbuses; i++) {
+            if (mgr->buses[i]->id && strcmp(mgr->buses[i]->id, id) == 0) {
+                return mgr->buses[i];
+            }
+        }
+    }
+
+    ssd1306_mgr_bus_t **buses = realloc(mgr->buses, (mgr->nbuses + 1) * sizeof(*buses));
+    if (!buses) {
+        perror("ssd1306: Failed to grow bus list");
+        return NULL;
+    }
+    mgr->buses = buses;
+    ssd1306_mgr_bus_t *bus = calloc(1, sizeof(*bus));
+    if (!bus || (id && !(bus->id = strdup(id)))) {
+        perror("ssd1306: Failed to allocate bus worker");
+        free(bus);
+        return NULL;
+    }
+    pthread_mutex_init(&bus->lock, NULL);
+    pthread_cond_init(&bus->wake, NULL);
+    int err = pthread_create(&bus->thread, NULL, ssd1306_mgr_worker, bus);
+    if (err != 0) {
+        fprintf(stderr, "ssd1306: Failed to start bus worker: %s\n", strerror(err));
+        pthread_cond_destroy(&bus->wake);
+        pthread_mutex_destroy(&bus->lock);
+        free(bus->id);
+        free(bus);
+        return NULL;
+    }
+    mgr->buses[mgr->nbuses++] = bus;
+    return bus;
+}
+
+int ssd1306_mgr_add(ssd1306_mgr_t *mgr, ssd1306_t *disp) {
+    for (size_t i = 0; i < mgr->nentries; i++) {
+        if (mgr->entries[i].disp == disp) {
+            return 0;
+        }
+    }
+    ssd1306_mgr_entry_t *entries = realloc(mgr->entries, (mgr->nentries + 1) * sizeof(*entries));
+    if (!entries) {
+        perror("ssd1306: Failed to grow display list");
+        return -1;
+    }
+    mgr->entries = entries;
+    const char *id = disp->ops->bus_id ? disp->ops->bus_id(disp->ctx) : NULL;
+    ssd1306_mgr_bus_t *bus = ssd1306_mgr_bus(mgr, id);
+    if (!bus) {
+        return -1;
+    }
+    mgr->entries[mgr->nentries++] = (ssd1306_mgr_entry_t){ disp, bus };
+    return 0;
+}
+
+int ssd1306_mgr_flush(ssd1306_mgr_t *mgr, ssd1306_t *const *displays, size_t count) {
+    if (!displays) {
+        count = mgr->nentries;
+    }
+    if (count == 0) {
+        return 0;
+    }
+    ssd1306_mgr_job_t *jobs = calloc(count, sizeof(*jobs));
+    if (!jobs) {
+        perror("ssd1306: Failed to allocate flush jobs");
+        return -1;
+    }
+
+    ssd1306_mgr_group_t group;
+    pthread_mutex_init(&group.lock, NULL);
+    pthread_cond_init(&group.done, NULL);
+    group.pending = count;
+    group.failed = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        ssd1306_mgr_bus_t *bus = NULL;
+        ssd1306_t *disp = displays ? displays[i] : mgr->entries[i].disp;
+        for (size_t e = 0; e < mgr->nentries; e++) {
+            if (mgr->entries[e].disp == disp) {
+                bus = mgr->entries[e].bus;
+                break;
+            }
+        }
+        if (!bus) {
+            fprintf(stderr, "ssd1306: Display is not registered with the manager\n");
+            pthread_mutex_lock(&group.lock);
+            group.failed = 1;
+            group.pending--;
+            pthread_mutex_unlock(&group.lock);
+            continue;
+        }
+
+        jobs[i].disp = disp;
+        jobs[i].group = &group;
+        pthread_mutex_lock(&bus->lock);
+        if (bus->tail) {
+            bus->tail->next = &jobs[i];
+        } else {
+            bus->head = &jobs[i];
+        }
+        bus->tail = &jobs[i];
+        pthread_cond_signal(&bus->wake);
+        pthread_mutex_unlock(&bus->lock);
+    }
+
+    pthread_mutex_lock(&group.lock);
+    while (group.pending > 0) {
+        pthread_cond_wait(&group.done, &group.lock);
+    }
+    pthread_mutex_unlock(&group.lock);
+
+    pthread_cond_destroy(&group.done);
+    pthread_mutex_destroy(&group.lock);
+    free(jobs);
+    return group.failed ? -1 : 0;
+}
+
+void ssd1306_mgr_destroy(ssd1306_mgr_t *mgr) {
+    if (!mgr) {
+        return;
+    }
+    for (size_t i = 0; i < mgr->nbuses; i++) {
+        ssd1306_mgr_bus_t *bus = mgr->buses[i];
+        pthread_mutex_lock(&bus->lock);
+        bus->stop = 1;
+        pthread_cond_signal(&bus->wake);
+        pthread_mutex_unlock(&bus->lock);
+        pthread_join(bus->thread, NULL);
+        pthread_cond_destroy(&bus->wake);
+        pthread_mutex_destroy(&bus->lock);
+        free(bus->id);
+        free(bus);
+    }
+    free(mgr->buses);
+    free(mgr->entries);
+    free(mgr);
+}
@@ -0,0 +1,144 @@
+#include "ssd1306_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <time.h>
+
+// Slack left between the end of the expected render time and the slot, for
+// wakeup latency.
+#define PACE_MARGIN_NS 300000ULL
+
+// Slowest rate the pacer falls back to: the target rate divided by this.
+#define PACE_MAX_DIVISOR 16
+
+// Averages move by 1/8 of each new sample.
+#define EWMA(avg, sample) ((avg) = (avg) - ((avg) >> 3) + ((sample) >> 3))
+
+struct ssd1306_pacer {
+    ssd1306_t *disp;
+    uint64_t target_ns;        // Slot period at the requested rate.
+    unsigned divisor;          // Slots are this many target periods apart.
+    atomic_int stop;
+    uint64_t render_ns;        // Average callback time,
+    uint64_t render_dev_ns;    // and its average deviation.
+    uint64_t frame_bus_ns;     // Average bus time of a frame update.
+    uint64_t seen_bus_ns;      // Display counters at the previous slot.
+    uint64_t seen_frames;
+    uint64_t slots, missed;
+};
+
+ssd1306_pacer_t *ssd1306_pacer_create(ssd1306_t *disp, unsigned hz) {
+    if (hz == 0) {
+        fprintf(stderr, "ssd1306: Pacer rate must be at least 1 Hz\n");
+        return NULL;
+    }
+    ssd1306_pacer_t *p = calloc(1, sizeof(*p));
+    if (!p) {
+        perror("ssd1306: Failed to allocate pacer");
+        return NULL;
+    }
+    p->disp = disp;
+    p->target_ns = 1000000000ULL / hz;
+    p->divisor = 1;
+    atomic_init(&p->stop, 0);
+    return p;
+}
+
+void ssd1306_pacer_destroy(ssd1306_pacer_t *p) {
+    free(p);
+}
+
+void ssd1306_pacer_stop(ssd1306_pacer_t *p) {
+    atomic_store(&p->stop, 1);
+}
+
+// Private helper: sleep until a CLOCK_MONOTONIC time, or until stopped.
+static void ssd1306_pacer_sleep(ssd1306_pacer_t *p, uint64_t until_ns) {
+    struct timespec ts = { .tv_sec = (time_t)(until_ns / 1000000000ULL), .tv_nsec = (long)(until_ns % 1000000000ULL) };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR && !atomic_load(&p->stop)) {
+    }
+}
+
+// Private helper: learn what the last slot cost on the bus and pick the
+// rate the bus can keep up with. A frame may take up to 90% of a slot; the
+// rate goes back up once frames would fit in 60% of the faster slot, so it
+// does not flap at the boundary.
+static void ssd1306_pacer_adapt(ssd1306_pacer_t *p) {
+    ssd1306_stats_t st;
+    ssd1306_get_stats(p->disp, &st);
+    uint64_t frames = st.frames - p->seen_frames, bus_ns = st.bus_ns - p->seen_bus_ns;
+    p->seen_frames = st.frames;
+    p->seen_bus_ns = st.bus_ns;
+    if (frames == 0) {
+        return;
+    }
+    uint64_t cost = bus_ns / frames;
+    if (p->frame_bus_ns == 0) {
+        p->frame_bus_ns = cost;
+    } else {
+        EWMA(p->frame_bus_ns, cost);
+    }
+
+    uint64_t budget = p->target_ns * 9 / 10;
+    if (p->frame_bus_ns > budget * p->divisor) {
+        uint64_t need = (p->frame_bus_ns + budget - 1) / budget;
+        p->divisor = need > PACE_MAX_DIVISOR ? PACE_MAX_DIVISOR : (unsigned)need;
+    } else if (p->divisor > 1 && p->frame_bus_ns < p->target_ns * (p->divisor - 1) * 6 / 10) {
+        p->divisor--;
+    }
+}
+
+int ssd1306_pacer_run(ssd1306_pacer_t *p, ssd1306_frame_fn render, void *arg) {
+    atomic_store(&p->stop, 0);
+    uint64_t slot = ssd1306_now_ns() + p->target_ns;
+
+    while (!atomic_load(&p->stop)) {
+        // Wake up just early enough for the callback to finish by the slot.
+        uint64_t lead = p->render_ns + 4 * p->render_dev_ns + PACE_MARGIN_NS;
+        if (slot > lead) {
+            ssd1306_pacer_sleep(p, slot - lead);
+        }
+        if (atomic_load(&p->stop)) {
+            break;
+        }
+
+        uint64_t t0 = ssd1306_now_ns();
+        int ret = render(p->disp, slot, arg);
+        uint64_t t1 = ssd1306_now_ns();
+        uint64_t took = t1 - t0, dev = took > p->render_ns ? took - p->render_ns : p->render_ns - took;
+        if (p->slots == 0) {
+            p->render_ns = took;
+        } else {
+            EWMA(p->render_ns, took);
+            EWMA(p->render_dev_ns, dev);
+        }
+        p->slots++;
+        p->missed += t1 > slot;
+
+        // Everything drawn since the previous slot goes out as one update.
+        ssd1306_flush(p->disp);
+        if (ret != 0) {
+            return ret;
+        }
+        ssd1306_pacer_adapt(p);
+
+        // A late slot is not made up for: the next one is the first still ahead.
+        uint64_t period = p->target_ns * p->divisor, now = ssd1306_now_ns();
+        slot += period;
+        if (slot <= now) {
+            slot += ((now - slot) / period + 1) * period;
+        }
+    }
+    return 0;
+}
+
+void ssd1306_pacer_info(const ssd1306_pacer_t *p, ssd1306_pace_info_t *info) {
+    uint64_t period = p->target_ns * p->divisor;
+    info->hz = (unsigned)((1000000000ULL + period / 2) / period);
+    info->sustainable_hz = p->frame_bus_ns ? (unsigned)(1000000000ULL / p->frame_bus_ns) : 0;
+    info->frame_bus_ns = p->frame_bus_ns;
+    info->render_ns = p->render_ns;
+    info->slots = p->slots;
+    info->missed = p->missed;
+}
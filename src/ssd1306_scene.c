@@ -0,0 +1,317 @@
+#include "ssd1306_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Damage rectangles kept per frame before new ones are merged into old ones.
+#define SCENE_MAX_DAMAGE 16
+
+// A rectangle in panel pixels, x1/y1 exclusive. Empty when x0 >= x1.
+typedef struct {
+    int x0, y0, x1, y1;
+} ssd1306_rect_t;
+
+struct ssd1306_sprite {
+    ssd1306_scene_t *scene;
+    const uint8_t *bitmap;     // Page-major, (h + 7) / 8 pages of w columns.
+    uint8_t *own;              // Bitmap owned by the sprite (layers), or NULL.
+    int x, y, w, h, z, blend, visible;
+    int changed;               // Moved or restyled since the last render.
+    ssd1306_rect_t drawn;      // Where it was composited last, clipped; empty if nowhere.
+};
+
+struct ssd1306_scene {
+    ssd1306_t *disp;
+    ssd1306_sprite_t **sprites;      // In z order, lowest first.
+    size_t count, cap;
+    ssd1306_rect_t damage[SCENE_MAX_DAMAGE];
+    size_t ndamage;
+};
+
+static int64_t ssd1306_rect_area(const ssd1306_rect_t *r) {
+    return (int64_t)(r->x1 - r->x0) * (r->y1 - r->y0);
+}
+
+static ssd1306_rect_t ssd1306_rect_union(const ssd1306_rect_t *a, const ssd1306_rect_t *b) {
+    return (ssd1306_rect_t){ a->x0 < b->x0 ? a->x0 : b->x0, a->y0 < b->y0 ? a->y0 : b->y0,
+                             a->x1 > b->x1 ? a->x1 : b->x1, a->y1 > b->y1 ? a->y1 : b->y1 };
+}
+
+// Private helper: the part of a sprite's bounds on the panel.
+static ssd1306_rect_t ssd1306_sprite_bounds(const ssd1306_sprite_t *s) {
+    const ssd1306_geometry_t *g = &s->scene->disp->geom;
+    ssd1306_rect_t r = { s->x < 0 ? 0 : s->x, s->y < 0 ? 0 : s->y,
+                         s->x + s->w > g->width ? g->width : s->x + s->w,
+                         s->y + s->h > g->height ? g->height : s->y + s->h };
+    if (!s->visible || r.x0 >= r.x1 || r.y0 >= r.y1) {
+        r = (ssd1306_rect_t){ 0, 0, 0, 0 };
+    }
+    return r;
+}
+
+// Private helper: add a damaged area. Overlapping areas are merged; once the
+// list is full, the area is merged into the one it grows the least.
+static void ssd1306_scene_damage(ssd1306_scene_t *scene, ssd1306_rect_t r) {
+    if (r.x0 >= r.x1 || r.y0 >= r.y1) {
+        return;
+    }
+    for (;;) {
+        size_t best = scene->ndamage;
+        int64_t best_growth = INT64_MAX;
+        for (size_t i = 0; i < scene->ndamage; i++) {
+            const ssd1306_rect_t *d = &scene->damage[i];
+            ssd1306_rect_t u = ssd1306_rect_union(d, &r);
+            int overlap = r.x0 < d->x1 && d->x0 < r.x1 && r.y0 < d->y1 && d->y0 < r.y1;
+            int64_t growth = ssd1306_rect_area(&u) - ssd1306_rect_area(d) - ssd1306_rect_area(&r);
+            if (overlap || growth <= 0) {
+                best = i;
+                best_growth = INT64_MIN;
+                break;
+            }
+            if (growth < best_growth) {
+                best = i;
+                best_growth = growth;
+            }
+        }
+        if (best_growth != INT64_MIN && scene->ndamage < SCENE_MAX_DAMAGE) {
+            scene->damage[scene->ndamage++] = r;
+            return;
+        }
+        // The merged area may now overlap others: take it out and add it again.
+        r = ssd1306_rect_union(&scene->damage[best], &r);
+        scene->damage[best] = scene->damage[--scene->ndamage];
+    }
+}
+
+ssd1306_scene_t *ssd1306_scene_create(ssd1306_t *disp) {
+    ssd1306_scene_t *scene = calloc(1, sizeof(*scene));
+    if (!scene) {
+        perror("ssd1306: Failed to allocate scene");
+        return NULL;
+    }
+    scene->disp = disp;
+    // The first render paints the whole panel.
+    ssd1306_scene_damage(scene, (ssd1306_rect_t){ 0, 0, disp->geom.width, disp->geom.height });
+    return scene;
+}
+
+void ssd1306_scene_destroy(ssd1306_scene_t *scene) {
+    if (!scene) {
+        return;
+    }
+    for (size_t i = 0; i < scene->count; i++) {
+        free(scene->sprites[i]->own);
+        free(scene->sprites[i]);
+    }
+    free(scene->sprites);
+    free(scene);
+}
+
+// Private helper: move a sprite to its place in z order, above the sprites
+// already at its z.
+static void ssd1306_scene_sort(ssd1306_scene_t *scene, size_t i) {
+    ssd1306_sprite_t *s = scene->sprites[i];
+    while (i > 0 && scene->sprites[i - 1]->z > s->z) {
+        scene->sprites[i] = scene->sprites[i - 1];
+        i--;
+    }
+    while (i + 1 < scene->count && scene->sprites[i + 1]->z <= s->z) {
+        scene->sprites[i] = scene->sprites[i + 1];
+        i++;
+    }
+    scene->sprites[i] = s;
+}
+
+ssd1306_sprite_t *ssd1306_sprite_create(ssd1306_scene_t *scene, const uint8_t *bitmap, int w, int h,
+                                        int z, int blend) {
+    if (w <= 0 || h <= 0) {
+        return NULL;
+    }
+    if (scene->count == scene->cap) {
+        size_t cap = scene->cap ? scene->cap * 2 : 16;
+        ssd1306_sprite_t **sprites = realloc(scene->sprites, cap * sizeof(*sprites));
+        if (!sprites) {
+            perror("ssd1306: Failed to allocate sprite");
+            return NULL;
+        }
+        scene->sprites = sprites;
+        scene->cap = cap;
+    }
+    ssd1306_sprite_t *s = calloc(1, sizeof(*s));
+    if (!s) {
+        perror("ssd1306: Failed to allocate sprite");
+        return NULL;
+    }
+    if (!bitmap) {
+        s->own = calloc((size_t)(h + 7) / 8, (size_t)w);
+        if (!s->own) {
+            perror("ssd1306: Failed to allocate sprite");
+            free(s);
+            return NULL;
+        }
+        bitmap = s->own;
+    }
+    *s = (ssd1306_sprite_t){ .scene = scene, .bitmap = bitmap, .own = s->own, .w = w, .h = h,
+                             .z = z, .blend = blend, .visible = 1, .changed = 1 };
+    scene->sprites[scene->count++] = s;
+    ssd1306_scene_sort(scene, scene->count - 1);
+    return s;
+}
+
+void ssd1306_sprite_destroy(ssd1306_sprite_t *s) {
+    if (!s) {
+        return;
+    }
+    ssd1306_scene_t *scene = s->scene;
+    ssd1306_scene_damage(scene, s->drawn);
+    size_t i = 0;
+    while (scene->sprites[i] != s) {
+        i++;
+    }
+    memmove(&scene->sprites[i], &scene->sprites[i + 1], (scene->count - i - 1) * sizeof(s));
+    scene->count--;
+    free(s->own);
+    free(s);
+}
+
+void ssd1306_sprite_move(ssd1306_sprite_t *s, int x, int y) {
+    if (s->x != x || s->y != y) {
+        s->x = x;
+        s->y = y;
+        s->changed = 1;
+    }
+}
+
+void ssd1306_sprite_set_bitmap(ssd1306_sprite_t *s, const uint8_t *bitmap, int w, int h) {
+    if (s->own || w <= 0 || h <= 0) {
+        return;
+    }
+    s->bitmap = bitmap;
+    s->w = w;
+    s->h = h;
+    s->changed = 1;
+}
+
+void ssd1306_sprite_set_z(ssd1306_sprite_t *s, int z) {
+    if (s->z != z) {
+        s->z = z;
+        s->changed = 1;
+        size_t i = 0;
+        while (s->scene->sprites[i] != s) {
+            i++;
+        }
+        ssd1306_scene_sort(s->scene, i);
+    }
+}
+
+void ssd1306_sprite_set_blend(ssd1306_sprite_t *s, int blend) {
+    if (s->blend != blend) {
+        s->blend = blend;
+        s->changed = 1;
+    }
+}
+
+void ssd1306_sprite_set_visible(ssd1306_sprite_t *s, int visible) {
+    if (s->visible != !!visible) {
+        s->visible = !!visible;
+        s->changed = 1;
+    }
+}
+
+uint8_t *ssd1306_sprite_buffer(ssd1306_sprite_t *s) {
+    return s->own;
+}
+
+void ssd1306_sprite_damage(ssd1306_sprite_t *s, int x, int y, int w, int h) {
+    ssd1306_rect_t bounds = ssd1306_sprite_bounds(s);
+    ssd1306_rect_t r = { s->x + x, s->y + y, s->x + x + w, s->y + y + h };
+    // Only the part of the sprite on the panel matters.
+    r.x0 = r.x0 > bounds.x0 ? r.x0 : bounds.x0;
+    r.y0 = r.y0 > bounds.y0 ? r.y0 : bounds.y0;
+    r.x1 = r.x1 < bounds.x1 ? r.x1 : bounds.x1;
+    r.y1 = r.y1 < bounds.y1 ? r.y1 : bounds.y1;
+    ssd1306_scene_damage(s->scene, r);
+}
+
+// Private helper: blend the columns x0..x1-1 of a sprite into one page of
+// row bytes. row[] is indexed by panel column.
+static void ssd1306_sprite_blend(const ssd1306_sprite_t *s, int page, int x0, int x1, uint8_t *row) {
+    // rel: sprite row at the top of the page.
+    int rel = page * 8 - s->y;
+    if (rel <= -8 || rel >= s->h) {
+        return;
+    }
+    int sp = rel >= 0 ? rel / 8 : -1, sh = rel >= 0 ? rel % 8 : 8 + rel;
+    int last = (s->h - 1) / 8;
+
+    // Panel rows of this page the sprite covers.
+    int r0 = rel < 0 ? -rel : 0, r1 = s->h - rel < 8 ? s->h - rel : 8;
+    uint8_t cover = (uint8_t)((0xFF << r0) & (0xFF >> (8 - r1)));
+
+    int c0 = x0 > s->x ? x0 : s->x, c1 = x1 < s->x + s->w ? x1 : s->x + s->w;
+    for (int c = c0; c < c1; c++) {
+        const uint8_t *col = s->bitmap + (c - s->x);
+        unsigned lo = sp >= 0 ? col[(size_t)sp * s->w] : 0;
+        unsigned hi = sp + 1 <= last ? col[(size_t)(sp + 1) * s->w] : 0;
+        uint8_t bits = (uint8_t)(((lo | hi << 8) >> sh) & cover);
+        switch (s->blend) {
+        case SSD1306_BLEND_COPY:
+            row[c] = (uint8_t)((row[c] & ~cover) | bits);
+            break;
+        case SSD1306_BLEND_OR:
+            row[c] |= bits;
+            break;
+        case SSD1306_BLEND_AND:
+            row[c] &= (uint8_t)(bits | ~cover);
+            break;
+        case SSD1306_BLEND_XOR:
+            row[c] ^= bits;
+            break;
+        }
+    }
+}
+
+int ssd1306_scene_render(ssd1306_scene_t *scene) {
+    ssd1306_t *disp = scene->disp;
+
+    // A changed sprite damages where it was and where it is now.
+    for (size_t i = 0; i < scene->count; i++) {
+        ssd1306_sprite_t *s = scene->sprites[i];
+        if (s->changed) {
+            ssd1306_rect_t now = ssd1306_sprite_bounds(s);
+            ssd1306_scene_damage(scene, s->drawn);
+            ssd1306_scene_damage(scene, now);
+            s->drawn = now;
+            s->changed = 0;
+        }
+    }
+
+    // Recomposite each damaged area from a black background upward, and
+    // write back only its rows.
+    int touched = 0;
+    for (size_t d = 0; d < scene->ndamage; d++) {
+        ssd1306_rect_t r = scene->damage[d];
+        r.x1 = r.x1 < disp->geom.width ? r.x1 : disp->geom.width;
+        r.y1 = r.y1 < disp->geom.height ? r.y1 : disp->geom.height;
+        for (int page = r.y0 / 8; page * 8 < r.y1; page++) {
+            uint8_t row[SSD1306_WIDTH] = { 0 };
+            int r0 = r.y0 > page * 8 ? r.y0 - page * 8 : 0;
+            int r1 = r.y1 < page * 8 + 8 ? r.y1 - page * 8 : 8;
+            uint8_t rows = (uint8_t)((0xFF << r0) & (0xFF >> (8 - r1)));
+            for (size_t i = 0; i < scene->count; i++) {
+                const ssd1306_sprite_t *s = scene->sprites[i];
+                if (s->visible && s->x < r.x1 && s->x + s->w > r.x0) {
+                    ssd1306_sprite_blend(s, page, r.x0, r.x1, row);
+                }
+            }
+            uint8_t *fb = disp->fb[page];
+            for (int c = r.x0; c < r.x1; c++) {
+                fb[c] = (uint8_t)((fb[c] & ~rows) | (row[c] & rows));
+            }
+            ssd1306_mark_dirty(disp, (uint8_t)page, (uint8_t)r.x0, (uint8_t)(r.x1 - 1));
+            touched++;
+        }
+    }
+    scene->ndamage = 0;
+    return touched;
+}
@@ -0,0 +1,185 @@
+#include "ssd1306_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Hardware scroll intervals in frames per step, indexed by command code.
+static const uint16_t scroll_frames[8] = { 5, 64, 128, 256, 3, 4, 25, 2 };
+
+// Private helper: command code of the supported interval nearest to frames.
+static uint8_t ssd1306_scroll_code(unsigned frames) {
+    uint8_t best = 0;
+    for (uint8_t code = 1; code < 8; code++) {
+        if (abs((int)scroll_frames[code] - (int)frames) < abs((int)scroll_frames[best] - (int)frames)) {
+            best = code;
+        }
+    }
+    return best;
+}
+
+uint8_t ssd1306_scroll_pages(const ssd1306_scroll_t *scroll) {
+    if (scroll->mode == SSD1306_SCROLL_OFF) {
+        return 0;
+    }
+    uint8_t pages = 0;
+    for (uint8_t page = scroll->start_page; page <= scroll->end_page; page++) {
+        pages |= (uint8_t)(1u << page);
+    }
+    return pages;
+}
+
+void ssd1306_scroll_commands(const ssd1306_t *disp, ssd1306_cmdbuf_t *cb, const ssd1306_scroll_t *scroll) {
+    uint8_t code = ssd1306_scroll_code(scroll->frames);
+
+    if (scroll->vertical) {
+        ssd1306_cmdbuf_add(cb, 0xA3);                // Set vertical scroll area
+        ssd1306_cmdbuf_add(cb, scroll->area_top);    // Fixed rows at the top.
+        ssd1306_cmdbuf_add(cb, scroll->area_rows);   // Rows that scroll.
+        ssd1306_cmdbuf_add(cb, scroll->mode == SSD1306_SCROLL_LEFT ? 0x2A : 0x29);
+        ssd1306_cmdbuf_add(cb, scroll->mode != SSD1306_SCROLL_OFF); // Horizontal step (0: vertical only).
+        ssd1306_cmdbuf_add(cb, scroll->start_page);
+        ssd1306_cmdbuf_add(cb, code);                // Time interval.
+        ssd1306_cmdbuf_add(cb, scroll->end_page);
+        ssd1306_cmdbuf_add(cb, scroll->vertical);    // Vertical offset per step.
+    } else if (scroll->mode != SSD1306_SCROLL_OFF) {
+        ssd1306_cmdbuf_add(cb, scroll->mode == SSD1306_SCROLL_LEFT ? 0x27 : 0x26);
+        ssd1306_cmdbuf_add(cb, 0x00);                // Dummy byte.
+        ssd1306_cmdbuf_add(cb, scroll->start_page);
+        ssd1306_cmdbuf_add(cb, code);                // Time interval.
+        ssd1306_cmdbuf_add(cb, scroll->end_page);
+        // Column range. Older controllers treat these as dummy bytes and
+        // expect 0x00/0xFF, which is also what a full-width range sends.
+        uint8_t off = disp->geom.col_offset;
+        int full = scroll->start_col == 0 && scroll->end_col == SSD1306_WIDTH - 1;
+        ssd1306_cmdbuf_add(cb, full ? 0x00 : (uint8_t)(off + scroll->start_col));
+        ssd1306_cmdbuf_add(cb, full ? 0xFF : (uint8_t)(off + scroll->end_col));
+    } else {
+        return;
+    }
+    ssd1306_cmdbuf_add(cb, 0x2F);                    // Activate scroll.
+}
+
+void ssd1306_set_scroll(ssd1306_t *disp, const ssd1306_scroll_t *scroll) {
+    ssd1306_scroll_t s;
+
+    // Normalize, so that equal setups compare equal and off is all zero.
+    memset(&s, 0, sizeof(s));
+    if (scroll && (scroll->mode != SSD1306_SCROLL_OFF || scroll->vertical)) {
+        s.mode = scroll->mode == SSD1306_SCROLL_LEFT ? SSD1306_SCROLL_LEFT :
+                 scroll->mode != SSD1306_SCROLL_OFF ? SSD1306_SCROLL_RIGHT : SSD1306_SCROLL_OFF;
+        s.vertical = scroll->vertical % disp->geom.height;
+        s.start_page = scroll->start_page < disp->pages ? scroll->start_page : disp->pages - 1;
+        s.end_page = scroll->end_page < disp->pages ? scroll->end_page : disp->pages - 1;
+        if (s.end_page < s.start_page) {
+            s.end_page = s.start_page;
+        }
+        s.frames = scroll_frames[ssd1306_scroll_code(scroll->frames)];
+        if (s.mode != SSD1306_SCROLL_OFF && !s.vertical) {
+            s.start_col = scroll->start_col < disp->geom.width ? scroll->start_col : disp->geom.width - 1;
+            s.end_col = scroll->end_col < disp->geom.width ? scroll->end_col : disp->geom.width - 1;
+            if (s.end_col < s.start_col) {
+                s.end_col = s.start_col;
+            }
+        }
+        if (s.vertical) {
+            s.area_top = scroll->area_top;
+            s.area_rows = scroll->area_rows;
+            if (s.area_rows == 0 || s.area_top + s.area_rows > disp->geom.height) {
+                s.area_top = 0;
+                s.area_rows = disp->geom.height;
+            }
+        }
+    }
+    disp->view.scroll = s;
+}
+
+void ssd1306_get_scroll(const ssd1306_t *disp, ssd1306_scroll_t *scroll) {
+    *scroll = disp->view.scroll;
+}
+
+void ssd1306_rotate_region(ssd1306_t *disp, uint8_t start_page, uint8_t end_page,
+                           uint8_t start_col, uint8_t end_col, int cols) {
+    uint8_t tmp[SSD1306_WIDTH];
+    if (end_page >= disp->pages) {
+        end_page = disp->pages - 1;
+    }
+    if (end_col >= disp->geom.width) {
+        end_col = disp->geom.width - 1;
+    }
+    if (start_page > end_page || start_col > end_col) {
+        return;
+    }
+    int width = end_col - start_col + 1;
+    int shift = ((cols % width) + width) % width; // Columns moved to the right.
+    if (shift == 0) {
+        return;
+    }
+    for (uint8_t page = start_page; page <= end_page; page++) {
+        uint8_t *row = &disp->fb[page][start_col];
+        memcpy(tmp, row + width - shift, shift);
+        memmove(row + shift, row, width - shift);
+        memcpy(row, tmp, shift);
+        ssd1306_mark_dirty(disp, page, start_col, end_col);
+    }
+}
+
+void ssd1306_scroll_plan(const ssd1306_scroll_t *region, unsigned content_cols,
+                         unsigned cols_per_sec, unsigned duration_ms, ssd1306_scroll_plan_t *plan) {
+    unsigned pages = region->end_page >= region->start_page ? region->end_page - region->start_page + 1u : 1u;
+    unsigned width = region->end_col >= region->start_col ? region->end_col - region->start_col + 1u : 1u;
+
+    // Bytes to repaint the region once: its columns plus one cursor command
+    // per page, or a single one when full-width pages merge into one span.
+    size_t repaint = (size_t)pages * width + (width == SSD1306_WIDTH ? 3 : 3 * pages);
+    size_t steps = (size_t)cols_per_sec * (duration_ms ? duration_ms : 1000) / 1000;
+
+    memset(plan, 0, sizeof(*plan));
+    plan->frames = scroll_frames[0];
+    if (cols_per_sec == 0) {
+        return;
+    }
+
+    // Software redraws the region at every step. Hardware costs the setup
+    // (8 bytes), the stop (1 byte) and one repaint afterwards, since the
+    // scroll leaves panel RAM rotated.
+    plan->sw_bytes = steps * repaint;
+    plan->hw_bytes = 8 + 1 + repaint;
+
+    // The controller can only rotate what is already in RAM, at one column
+    // per step and at one of its fixed intervals. Use it when the content
+    // fits the region and some interval is within 25% of the wanted speed.
+    uint8_t code = ssd1306_scroll_code(PANEL_FRAME_HZ / cols_per_sec);
+    plan->frames = scroll_frames[code];
+    unsigned speed = PANEL_FRAME_HZ / plan->frames;
+    unsigned error = speed > cols_per_sec ? speed - cols_per_sec : cols_per_sec - speed;
+    int feasible = content_cols <= width && error * 4 <= cols_per_sec;
+    plan->hardware = feasible && plan->hw_bytes < plan->sw_bytes;
+}
+
+void ssd1306_start_scroll_left(ssd1306_t *disp, uint8_t start_page, uint8_t end_page, uint8_t scroll_speed) {
+    ssd1306_scroll_t s = {
+        .mode = SSD1306_SCROLL_LEFT,
+        .start_page = start_page,
+        .end_page = end_page,
+        .end_col = disp->geom.width - 1,
+        .frames = scroll_frames[scroll_speed & 0x07],
+    };
+    ssd1306_set_scroll(disp, &s);
+    ssd1306_flush(disp);
+}
+
+void ssd1306_start_scroll_right(ssd1306_t *disp, uint8_t start_page, uint8_t end_page, uint8_t scroll_speed) {
+    ssd1306_scroll_t s = {
+        .mode = SSD1306_SCROLL_RIGHT,
+        .start_page = start_page,
+        .end_page = end_page,
+        .end_col = disp->geom.width - 1,
+        .frames = scroll_frames[scroll_speed & 0x07],
+    };
+    ssd1306_set_scroll(disp, &s);
+    ssd1306_flush(disp);
+}
+
+void ssd1306_stop_scroll(ssd1306_t *disp) {
+    ssd1306_set_scroll(disp, NULL);
+    ssd1306_flush(disp);
+}
@@ -0,0 +1,311 @@
+#define _GNU_SOURCE
+#include "ssd1306_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+// Most clients served at once.
+#define SERVER_MAX_CLIENTS 16
+
+#define FRAME_BYTES (SSD1306_PAGES * SSD1306_WIDTH)
+
+// One connected client and the last complete frame of its layer.
+typedef struct {
+    int fd;                              // Socket, or -1 for a free slot.
+    int z;
+    const ssd1306_layer_shm_t *shm;      // Mapped read-only; NULL until attached.
+    int pending;                         // An update is not in the snapshot yet.
+    uint8_t pixels[FRAME_BYTES];
+    uint8_t mask[FRAME_BYTES];
+} ssd1306_server_client_t;
+
+struct ssd1306_server {
+    ssd1306_t *disp;
+    int listen_fd;
+    int stop_pipe[2];
+    char *path;
+    uint64_t tick_ns;
+    uint64_t last_refresh;
+    int dirty;                           // The composite must be redone.
+    ssd1306_server_client_t clients[SERVER_MAX_CLIENTS];
+};
+
+ssd1306_server_t *ssd1306_server_create(ssd1306_t *disp, const char *path, unsigned hz) {
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "ssd1306: Socket path too long: %s\n", path);
+        return NULL;
+    }
+    strcpy(addr.sun_path, path);
+
+    ssd1306_server_t *srv = calloc(1, sizeof(*srv));
+    if (!srv) {
+        perror("ssd1306: Failed to allocate server");
+        return NULL;
+    }
+    srv->disp = disp;
+    srv->tick_ns = 1000000000ULL / (hz ? hz : 30);
+    srv->stop_pipe[0] = srv->stop_pipe[1] = -1;
+    for (size_t i = 0; i < SERVER_MAX_CLIENTS; i++) {
+        srv->clients[i].fd = -1;
+    }
+
+    // A socket left behind by a server that died is replaced.
+    unlink(path);
+    srv->listen_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (srv->listen_fd < 0 || bind(srv->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(srv->listen_fd, SERVER_MAX_CLIENTS) < 0) {
+        perror("ssd1306: Failed to listen on server socket");
+        ssd1306_server_destroy(srv);
+        return NULL;
+    }
+    srv->path = strdup(path);
+    if (pipe2(srv->stop_pipe, O_CLOEXEC | O_NONBLOCK) < 0) {
+        perror("ssd1306: Failed to create server pipe");
+        ssd1306_server_destroy(srv);
+        return NULL;
+    }
+    return srv;
+}
+
+void ssd1306_server_stop(ssd1306_server_t *srv) {
+    char c = 0;
+    // Only async-signal-safe calls here: this runs from signal handlers.
+    if (write(srv->stop_pipe[1], &c, 1) < 0) {
+        return;
+    }
+}
+
+// Private helper: drop a client and uncover what its layer hid.
+static void ssd1306_server_drop(ssd1306_server_t *srv, ssd1306_server_client_t *c) {
+    if (c->shm) {
+        munmap((void *)c->shm, sizeof(*c->shm));
+        c->shm = NULL;
+        srv->dirty = 1;
+    }
+    close(c->fd);
+    c->fd = -1;
+    c->pending = 0;
+}
+
+void ssd1306_server_destroy(ssd1306_server_t *srv) {
+    if (!srv) {
+        return;
+    }
+    for (size_t i = 0; i < SERVER_MAX_CLIENTS; i++) {
+        if (srv->clients[i].fd >= 0) {
+            ssd1306_server_drop(srv, &srv->clients[i]);
+        }
+    }
+    if (srv->listen_fd >= 0) {
+        close(srv->listen_fd);
+    }
+    if (srv->path) {
+        unlink(srv->path);
+        free(srv->path);
+    }
+    for (int i = 0; i < 2; i++) {
+        if (srv->stop_pipe[i] >= 0) {
+            close(srv->stop_pipe[i]);
+        }
+    }
+    free(srv);
+}
+
+// Private helper: map a client's layer. The memfd must be sealed against
+// shrinking, or the client could truncate it and crash the server with
+// SIGBUS while it reads.
+static const ssd1306_layer_shm_t *ssd1306_server_map(int fd) {
+    struct stat st;
+    int seals = fcntl(fd, F_GET_SEALS);
+    if (seals < 0 || !(seals & F_SEAL_SHRINK) || fstat(fd, &st) < 0 ||
+        (size_t)st.st_size < sizeof(ssd1306_layer_shm_t)) {
+        return NULL;
+    }
+    void *shm = mmap(NULL, sizeof(ssd1306_layer_shm_t), PROT_READ, MAP_SHARED, fd, 0);
+    return shm == MAP_FAILED ? NULL : shm;
+}
+
+// Private helper: handle one message from a client. Returns -1 to drop it.
+static int ssd1306_server_recv(ssd1306_server_t *srv, ssd1306_server_client_t *c) {
+    ssd1306_msg_t msg;
+    union {
+        struct cmsghdr hdr;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } ctrl;
+    struct iovec iov = { &msg, sizeof(msg) };
+    struct msghdr mh = { .msg_iov = &iov, .msg_iovlen = 1, .msg_control = ctrl.buf, .msg_controllen = sizeof(ctrl.buf) };
+
+    ssize_t n = recvmsg(c->fd, &mh, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+    if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+        return 0;
+    }
+    int fd = -1;
+    struct cmsghdr *cm = CMSG_FIRSTHDR(&mh);
+    if (n > 0 && cm && cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_RIGHTS &&
+        cm->cmsg_len == CMSG_LEN(sizeof(int))) {
+        memcpy(&fd, CMSG_DATA(cm), sizeof(int));
+    }
+    if (n != (ssize_t)sizeof(msg) || (mh.msg_flags & MSG_CTRUNC)) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        return -1;
+    }
+
+    if (msg.type == MSG_ATTACH && !c->shm && fd >= 0) {
+        c->shm = ssd1306_server_map(fd);
+        close(fd);
+        ssd1306_msg_t reply = { .type = MSG_WELCOME, .status = c->shm ? 0 : -1 };
+        ssd1306_get_geometry(srv->disp, &reply.geom);
+        send(c->fd, &reply, sizeof(reply), MSG_NOSIGNAL);
+        if (!c->shm) {
+            return -1;
+        }
+        c->z = msg.z;
+        return 0;
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+    if (msg.type == MSG_UPDATE && c->shm) {
+        c->pending = 1;
+        return 0;
+    }
+    return -1;
+}
+
+// Private helper: copy the layers that changed, composite every layer in z
+// order and flush the result. A layer caught mid-write keeps its previous
+// frame and is retried on the next tick.
+static void ssd1306_server_refresh(ssd1306_server_t *srv) {
+    ssd1306_server_client_t *order[SERVER_MAX_CLIENTS];
+    size_t n = 0;
+
+    for (size_t i = 0; i < SERVER_MAX_CLIENTS; i++) {
+        ssd1306_server_client_t *c = &srv->clients[i];
+        if (!c->shm) {
+            continue;
+        }
+        if (c->pending) {
+            uint32_t seq = atomic_load_explicit(&c->shm->seq, memory_order_acquire);
+            if (!(seq & 1)) {
+                memcpy(c->pixels, c->shm->pixels, FRAME_BYTES);
+                memcpy(c->mask, c->shm->mask, FRAME_BYTES);
+                atomic_thread_fence(memory_order_acquire);
+                if (atomic_load_explicit(&c->shm->seq, memory_order_relaxed) == seq) {
+                    c->pending = 0;
+                    srv->dirty = 1;
+                }
+            }
+        }
+        // Insertion sort by z; equal z keeps connection order.
+        size_t k = n++;
+        while (k > 0 && order[k - 1]->z > c->z) {
+            order[k] = order[k - 1];
+            k--;
+        }
+        order[k] = c;
+    }
+    if (!srv->dirty) {
+        return;
+    }
+
+    ssd1306_geometry_t geom;
+    ssd1306_get_geometry(srv->disp, &geom);
+    uint8_t *fb = ssd1306_get_buffer(srv->disp);
+    for (uint8_t page = 0; page < geom.height / 8; page++) {
+        uint8_t row[SSD1306_WIDTH] = { 0 };
+        size_t base = (size_t)page * SSD1306_WIDTH;
+        for (size_t i = 0; i < n; i++) {
+            const uint8_t *pix = &order[i]->pixels[base], *mask = &order[i]->mask[base];
+            for (uint8_t col = 0; col < geom.width; col++) {
+                row[col] = (uint8_t)((row[col] & ~mask[col]) | (pix[col] & mask[col]));
+            }
+        }
+        // The display diffs against what the panel shows; marking just the
+        // changed range keeps the diff short.
+        int lo = 0, hi = geom.width - 1;
+        while (lo <= hi && row[lo] == fb[base + lo]) {
+            lo++;
+        }
+        while (hi >= lo && row[hi] == fb[base + hi]) {
+            hi--;
+        }
+        if (lo <= hi) {
+            memcpy(&fb[base + lo], &row[lo], (size_t)(hi - lo + 1));
+            ssd1306_mark_dirty(srv->disp, page, (uint8_t)lo, (uint8_t)hi);
+        }
+    }
+    if (ssd1306_flush(srv->disp) == 0) {
+        srv->dirty = 0;
+    }
+}
+
+int ssd1306_server_run(ssd1306_server_t *srv) {
+    struct pollfd fds[2 + SERVER_MAX_CLIENTS];
+    ssd1306_server_client_t *owners[2 + SERVER_MAX_CLIENTS];
+
+    for (;;) {
+        size_t nfds = 0;
+        fds[nfds++] = (struct pollfd){ .fd = srv->stop_pipe[0], .events = POLLIN };
+        fds[nfds++] = (struct pollfd){ .fd = srv->listen_fd, .events = POLLIN };
+        int waiting = srv->dirty;
+        for (size_t i = 0; i < SERVER_MAX_CLIENTS; i++) {
+            if (srv->clients[i].fd >= 0) {
+                owners[nfds] = &srv->clients[i];
+                fds[nfds++] = (struct pollfd){ .fd = srv->clients[i].fd, .events = POLLIN };
+                waiting |= srv->clients[i].pending;
+            }
+        }
+
+        // Sleep until the next refresh tick when there is something to
+        // show, otherwise until a client speaks.
+        int timeout = -1;
+        if (waiting) {
+            uint64_t now = ssd1306_now_ns(), due = srv->last_refresh + srv->tick_ns;
+            timeout = due > now ? (int)((due - now + 999999) / 1000000) : 0;
+        }
+        if (poll(fds, nfds, timeout) < 0 && errno != EINTR) {
+            perror("ssd1306: Server poll failed");
+            return -1;
+        }
+
+        if (fds[0].revents) {
+            return 0;
+        }
+        if (fds[1].revents & POLLIN) {
+            int fd = accept4(srv->listen_fd, NULL, NULL, SOCK_CLOEXEC);
+            size_t i = 0;
+            while (i < SERVER_MAX_CLIENTS && srv->clients[i].fd >= 0) {
+                i++;
+            }
+            if (fd >= 0 && i == SERVER_MAX_CLIENTS) {
+                close(fd);
+            } else if (fd >= 0) {
+                srv->clients[i].fd = fd;
+            }
+        }
+        for (size_t i = 2; i < nfds; i++) {
+            if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+                if (ssd1306_server_recv(srv, owners[i]) < 0) {
+                    ssd1306_server_drop(srv, owners[i]);
+                }
+            }
+        }
+
+        uint64_t now = ssd1306_now_ns();
+        if (now - srv->last_refresh >= srv->tick_ns) {
+            srv->last_refresh = now;
+            ssd1306_server_refresh(srv);
+        }
+    }
+}
@@ -0,0 +1,165 @@
+#include "ssd1306_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <linux/spi/spidev.h>
+#include <sys/ioctl.h>
+#include <string.h>
+
+// spidev's default bufsiz: the most bytes one SPI_IOC_MESSAGE may carry.
+#define SPIDEV_MAX_MSG 4096
+
+// Transfers per SPI_IOC_MESSAGE batch.
+#define SPI_MAX_XFERS 16
+
+// Clock used when the caller passes 0.
+#define SPI_DEFAULT_HZ 8000000
+
+typedef struct {
+    int fd;
+    char *bus;            // "/dev/spidevB" for /dev/spidevB.C: chip selects share the bus.
+    uint32_t speed_hz;
+    size_t max_msg;       // Bytes per SPI_IOC_MESSAGE.
+    ssd1306_dc_fn set_dc;
+    void *user;
+    int dc;               // Current D/C level, or -1 before the first transfer.
+    ssd1306_bus_stats_t counters;
+} ssd1306_spi_t;
+
+static void ssd1306_spi_close(void *ctx) {
+    ssd1306_spi_t *spi = ctx;
+    if (spi->fd >= 0) {
+        close(spi->fd);
+    }
+    free(spi->bus);
+    free(spi);
+}
+
+static const char *ssd1306_spi_bus_id(void *ctx) {
+    return ((ssd1306_spi_t *)ctx)->bus;
+}
+
+static void ssd1306_spi_stats(void *ctx, ssd1306_bus_stats_t *stats) {
+    *stats = ((ssd1306_spi_t *)ctx)->counters;
+}
+
+static void ssd1306_spi_cost(void *ctx, ssd1306_cost_t *cost) {
+    ssd1306_spi_t *spi = ctx;
+    // Every switch between commands and data means a D/C change and a new
+    // SPI_IOC_MESSAGE, which costs far more than the bytes themselves.
+    cost->xfer_ns = 15000;
+    cost->seg_ns = 15000;
+    cost->byte_ns = (uint32_t)(8 * 1000000000ULL / spi->speed_hz);
+}
+
+static void ssd1306_spi_set_max_transfer(void *ctx, size_t bytes) {
+    ssd1306_spi_t *spi = ctx;
+    if (bytes >= 1 && bytes < spi->max_msg) {
+        spi->max_msg = bytes;
+    }
+}
+
+static int ssd1306_spi_xfer(void *ctx, const ssd1306_seg_t *segs, size_t nsegs) {
+    ssd1306_spi_t *spi = ctx;
+    size_t seg = 0, off = 0;
+
+    while (seg < nsegs) {
+        // The D/C line cannot change inside one SPI_IOC_MESSAGE, so each
+        // batch covers a run of segments of the same kind.
+        uint8_t ctrl = segs[seg].ctrl;
+        int dc = ctrl == SSD1306_CTRL_DATA;
+        if (spi->dc != dc) {
+            if (spi->set_dc(spi->user, dc) < 0) {
+                fprintf(stderr, "ssd1306: Failed to drive the D/C line\n");
+                return -1;
+            }
+            spi->dc = dc;
+        }
+
+        struct spi_ioc_transfer xfers[SPI_MAX_XFERS];
+        size_t nxfers = 0, total = 0;
+        memset(xfers, 0, sizeof(xfers));
+        while (seg < nsegs && segs[seg].ctrl == ctrl &&
+               nxfers < SPI_MAX_XFERS && total < spi->max_msg) {
+            size_t len = segs[seg].len - off;
+            if (len > spi->max_msg - total) {
+                len = spi->max_msg - total;
+            }
+            if (len > 0) {
+                xfers[nxfers].tx_buf = (uintptr_t)(segs[seg].buf + off);
+                xfers[nxfers].len = (uint32_t)len;
+                xfers[nxfers].speed_hz = spi->speed_hz;
+                xfers[nxfers].bits_per_word = 8;
+                nxfers++;
+                total += len;
+                off += len;
+            }
+            if (off >= segs[seg].len) {
+                seg++;
+                off = 0;
+            }
+        }
+        if (nxfers > 0) {
+            int ret = ioctl(spi->fd, SPI_IOC_MESSAGE(nxfers), xfers);
+            if (ret < 0) {
+                perror("ssd1306: SPI transfer failed");
+                return -1;
+            }
+            if ((size_t)ret < total) {
+                spi->counters.short_writes++;
+                fprintf(stderr, "ssd1306: SPI transfer cut short after %d of %zu bytes\n", ret, total);
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+static const ssd1306_transport_ops_t ssd1306_spi_ops = {
+    .name = "spi",
+    .xfer = ssd1306_spi_xfer,
+    .set_max_transfer = ssd1306_spi_set_max_transfer,
+    .close = ssd1306_spi_close,
+    .bus_id = ssd1306_spi_bus_id,
+    .cost = ssd1306_spi_cost,
+    .stats = ssd1306_spi_stats,
+};
+
+ssd1306_t *ssd1306_init_spi(const char *spi_dev, uint32_t speed_hz, ssd1306_dc_fn set_dc, void *user) {
+    if (!set_dc) {
+        fprintf(stderr, "ssd1306: SPI transport needs a D/C line hook\n");
+        return NULL;
+    }
+    ssd1306_spi_t *spi = calloc(1, sizeof(*spi));
+    if (!spi) {
+        perror("ssd1306: Failed to allocate SPI transport");
+        return NULL;
+    }
+    spi->fd = open(spi_dev, O_RDWR);
+    if (spi->fd < 0) {
+        perror("ssd1306: Failed to open SPI device");
+        free(spi);
+        return NULL;
+    }
+    uint8_t mode = SPI_MODE_0;
+    uint8_t bits = 8;
+    spi->speed_hz = speed_hz ? speed_hz : SPI_DEFAULT_HZ;
+    if (ioctl(spi->fd, SPI_IOC_WR_MODE, &mode) < 0 ||
+        ioctl(spi->fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0 ||
+        ioctl(spi->fd, SPI_IOC_WR_MAX_SPEED_HZ, &spi->speed_hz) < 0) {
+        perror("ssd1306: Failed to configure SPI device");
+        ssd1306_spi_close(spi);
+        return NULL;
+    }
+    spi->bus = strdup(spi_dev);
+    char *dot = spi->bus ? strrchr(spi->bus, '.') : NULL;
+    if (dot) {
+        *dot = '\0';
+    }
+    spi->max_msg = SPIDEV_MAX_MSG;
+    spi->set_dc = set_dc;
+    spi->user = user;
+    spi->dc = -1;
+    return ssd1306_init_transport(&ssd1306_spi_ops, spi);
+}
@@ -0,0 +1,197 @@
+#include "ssd1306_internal.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+// Layout version of the state file; bump it whenever ssd1306_state_file_t
+// or ssd1306_view_t changes.
+#define STATE_VERSION 2
+
+// Where the kernel names the current boot.
+#define BOOT_ID_PATH "/proc/sys/kernel/random/boot_id"
+
+// What a detached display leaves for the next process: the panel's
+// configuration and RAM as the library last sent them. Written whole, with
+// a CRC over everything before it.
+typedef struct {
+    char magic[8];                                // "SSD1306S".
+    uint32_t version;
+    uint32_t size;                                // sizeof(ssd1306_state_file_t).
+    char boot_id[40];                             // Boot the panel was configured in.
+    char transport[16];                           // ops->name.
+    char bus[64];                                 // ops->bus_id(), if any.
+    char dev[16];                                 // ops->dev_id(), if any.
+    ssd1306_geometry_t geom;
+    uint8_t window[4];                            // Address window in panel coordinates.
+    ssd1306_view_t view;                          // Start line, contrast, scroll.
+    uint8_t ram[SSD1306_PAGES][SSD1306_WIDTH];    // What the panel shows.
+    uint32_t crc;
+} ssd1306_state_file_t;
+
+// Private helper: CRC-32 (IEEE 802.3) of n bytes.
+static uint32_t ssd1306_crc32(const void *data, size_t n) {
+    const uint8_t *p = data;
+    uint32_t crc = 0xFFFFFFFF;
+    while (n--) {
+        crc ^= *p++;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+// Private helper: read the boot ID into buf. Returns 0 on success, -1 if
+// the kernel does not provide one.
+static int ssd1306_boot_id(char *buf, size_t size) {
+    FILE *fp = fopen(BOOT_ID_PATH, "r");
+    if (!fp) {
+        return -1;
+    }
+    memset(buf, 0, size);
+    int ok = fgets(buf, (int)size, fp) != NULL;
+    fclose(fp);
+    buf[strcspn(buf, "\n")] = '\0';
+    return ok && buf[0] ? 0 : -1;
+}
+
+// Private helper: describe disp the way the state file identifies a panel.
+static void ssd1306_state_identity(const ssd1306_t *disp, ssd1306_state_file_t *st) {
+    const char *bus = disp->ops->bus_id ? disp->ops->bus_id(disp->ctx) : NULL;
+    const char *dev = disp->ops->dev_id ? disp->ops->dev_id(disp->ctx) : NULL;
+    snprintf(st->transport, sizeof(st->transport), "%s", disp->ops->name ? disp->ops->name : "");
+    snprintf(st->bus, sizeof(st->bus), "%s", bus ? bus : "");
+    snprintf(st->dev, sizeof(st->dev), "%s", dev ? dev : "");
+}
+
+// Private helper: take over the panel from a state file that matches disp
+// and geom. The file is consumed whether or not it matches: the panel is
+// only known while one process owns it. Returns 0 on success, -1 if the
+// panel has to be initialized.
+static int ssd1306_state_load(ssd1306_t *disp, const ssd1306_geometry_t *geom, const char *path) {
+    ssd1306_state_file_t st, id;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    ssize_t n = read(fd, &st, sizeof(st));
+    close(fd);
+    // Only the process that removes the file may use it.
+    if (unlink(path) < 0) {
+        return -1;
+    }
+
+    memset(&id, 0, sizeof(id));
+    ssd1306_state_identity(disp, &id);
+    if (n != (ssize_t)sizeof(st) || memcmp(st.magic, "SSD1306S", sizeof(st.magic)) != 0 ||
+        st.version != STATE_VERSION || st.size != sizeof(st) ||
+        st.crc != ssd1306_crc32(&st, offsetof(ssd1306_state_file_t, crc)) ||
+        ssd1306_boot_id(id.boot_id, sizeof(id.boot_id)) < 0 ||
+        strncmp(st.boot_id, id.boot_id, sizeof(st.boot_id)) != 0 ||
+        strncmp(st.transport, id.transport, sizeof(st.transport)) != 0 ||
+        strncmp(st.bus, id.bus, sizeof(st.bus)) != 0 ||
+        strncmp(st.dev, id.dev, sizeof(st.dev)) != 0 ||
+        memcmp(&st.geom, geom, sizeof(*geom)) != 0) {
+        return -1;
+    }
+
+    disp->geom = st.geom;
+    disp->pages = st.geom.height / 8;
+    memcpy(disp->window, st.window, sizeof(disp->window));
+    disp->view = st.view;
+    disp->panel_view = st.view;
+    memcpy(disp->shadow, st.ram, sizeof(disp->shadow));
+    memcpy(disp->fb, st.ram, sizeof(disp->fb));
+    disp->shadow_valid = 1;
+    return 0;
+}
+
+ssd1306_t *ssd1306_attach_transport(const ssd1306_transport_ops_t *ops, void *ctx,
+                                    const ssd1306_geometry_t *geom, const char *state_path) {
+    if (!geom) {
+        geom = &ssd1306_128x64;
+    }
+    if (!state_path) {
+        state_path = SSD1306_STATE_PATH;
+    }
+    ssd1306_t *disp = ssd1306_alloc(ops, ctx);
+    if (!disp) {
+        return NULL;
+    }
+    if (ssd1306_state_load(disp, geom, state_path) == 0) {
+        disp->warm = 1;
+        return disp;
+    }
+    // Stale or missing state: bring the panel up from scratch.
+    if (ssd1306_cold_init(disp) < 0 ||
+        (memcmp(geom, &disp->geom, sizeof(*geom)) != 0 && ssd1306_set_geometry(disp, geom) < 0)) {
+        ssd1306_close(disp);
+        return NULL;
+    }
+    return disp;
+}
+
+int ssd1306_is_warm(const ssd1306_t *disp) {
+    return disp->warm;
+}
+
+int ssd1306_save_state(ssd1306_t *disp, const char *state_path) {
+    ssd1306_state_file_t st;
+    if (!state_path) {
+        state_path = SSD1306_STATE_PATH;
+    }
+    if (disp->async || disp->client) {
+        fprintf(stderr, "ssd1306: Cannot save the state of an async or client display\n");
+        return -1;
+    }
+    if (!disp->shadow_valid || disp->ram_uncertain) {
+        fprintf(stderr, "ssd1306: Panel content is unknown, not saving state\n");
+        return -1;
+    }
+
+    memset(&st, 0, sizeof(st));
+    memcpy(st.magic, "SSD1306S", sizeof(st.magic));
+    st.version = STATE_VERSION;
+    st.size = sizeof(st);
+    if (ssd1306_boot_id(st.boot_id, sizeof(st.boot_id)) < 0) {
+        fprintf(stderr, "ssd1306: Failed to read boot ID\n");
+        return -1;
+    }
+    ssd1306_state_identity(disp, &st);
+    st.geom = disp->geom;
+    memcpy(st.window, disp->window, sizeof(st.window));
+    st.view = disp->panel_view;
+    memcpy(st.ram, disp->shadow, sizeof(st.ram));
+    st.crc = ssd1306_crc32(&st, offsetof(ssd1306_state_file_t, crc));
+
+    // Write a temporary file and rename it, so readers never see half a state.
+    char tmp[4096];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", state_path);
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        perror("ssd1306: Failed to create state file");
+        return -1;
+    }
+    ssize_t n = write(fd, &st, sizeof(st));
+    if (close(fd) < 0 || n != (ssize_t)sizeof(st)) {
+        perror("ssd1306: Failed to write state file");
+        unlink(tmp);
+        return -1;
+    }
+    if (rename(tmp, state_path) < 0) {
+        perror("ssd1306: Failed to install state file");
+        unlink(tmp);
+        return -1;
+    }
+    return 0;
+}
+
+int ssd1306_detach(ssd1306_t *disp, const char *state_path) {
+    // Stopping the worker sends the last published frame.
+    ssd1306_async_stop(disp);
+    int ret = disp->client ? -1 : ssd1306_save_state(disp, state_path);
+    ssd1306_close(disp);
+    return ret;
+}
@@ -0,0 +1,189 @@
+#include "ssd1306_internal.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+static const char *const plan_names[] = { "none", "spans", "window", "full" };
+
+// Private helper: histogram bucket of a latency. Values below 4 us get a
+// bucket each; above that every power of two is split into four.
+static unsigned ssd1306_latency_bucket(uint32_t us) {
+    if (us < 4) {
+        return us;
+    }
+    unsigned msb = 31 - (unsigned)__builtin_clz(us);
+    return 4 * (msb - 1) + ((us >> (msb - 2)) & 3);
+}
+
+// Private helper: largest latency that falls into a bucket.
+static uint32_t ssd1306_latency_bound(unsigned bucket) {
+    if (bucket < 4) {
+        return bucket;
+    }
+    unsigned msb = bucket / 4 + 1;
+    uint64_t lo = (uint64_t)(4 + bucket % 4) << (msb - 2);
+    uint64_t hi = lo + (1ULL << (msb - 2)) - 1;
+    return hi > UINT32_MAX ? UINT32_MAX : (uint32_t)hi;
+}
+
+// Private helper: the latency below which a fraction num/den of updates fall.
+static uint32_t ssd1306_latency_percentile(const ssd1306_t *disp, uint64_t total, unsigned num, unsigned den) {
+    uint64_t rank = (total * num + den - 1) / den, seen = 0;
+    for (unsigned i = 0; i < LATENCY_BUCKETS; i++) {
+        seen += disp->latency[i];
+        if (seen >= rank && seen > 0) {
+            uint32_t bound = ssd1306_latency_bound(i);
+            return bound < disp->latency_max_us ? bound : disp->latency_max_us;
+        }
+    }
+    return 0;
+}
+
+// Private helper: start a trace event. Chrome's JSON array format needs no
+// closing bracket, so a trace cut short by a crash still loads.
+static void ssd1306_trace_begin(ssd1306_t *disp, const char *name, const char *cat, const char *ph,
+                                uint64_t ts_ns) {
+    fprintf(disp->trace, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":%d,\"tid\":%ld",
+            disp->trace_events++ ? ",\n" : "", name, cat, ph, ts_ns / 1000.0,
+            (int)getpid(), (long)syscall(SYS_gettid));
+}
+
+int ssd1306_xfer(ssd1306_t *disp, const ssd1306_seg_t *segs, size_t nsegs) {
+    uint64_t t_wait = ssd1306_now_ns();
+    pthread_mutex_lock(&disp->xfer_lock);
+    uint64_t t_start = ssd1306_now_ns();
+    int ret = disp->ops->xfer(disp->ctx, segs, nsegs);
+    uint64_t t_end = ssd1306_now_ns();
+    if (ret < 0) {
+        disp->ram_uncertain = 1;
+    }
+
+    // Only the difference since the last transfer belongs to this one.
+    ssd1306_bus_stats_t bus = disp->bus_seen;
+    if (disp->ops->stats) {
+        disp->ops->stats(disp->ctx, &bus);
+    }
+    uint64_t short_writes = bus.short_writes - disp->bus_seen.short_writes;
+    uint64_t retries = bus.retries - disp->bus_seen.retries;
+    disp->bus_seen = bus;
+    pthread_mutex_unlock(&disp->xfer_lock);
+
+    size_t bytes = 0;
+    for (size_t i = 0; i < nsegs; i++) {
+        bytes += segs[i].len;
+    }
+
+    pthread_mutex_lock(&disp->stats_lock);
+    ssd1306_stats_t *s = &disp->stats;
+    s->xfers++;
+    s->segs += nsegs;
+    s->bytes += bytes;
+    s->errors += ret < 0;
+    s->short_writes += short_writes;
+    s->retries += retries;
+    s->bus_ns += t_end - t_start;
+    s->wait_ns += t_start - t_wait;
+    if (disp->trace) {
+        ssd1306_trace_begin(disp, "xfer", "bus", "X", t_start);
+        fprintf(disp->trace, ",\"dur\":%.3f,\"args\":{\"bytes\":%zu,\"segs\":%zu,\"wait_us\":%.3f,"
+                "\"retries\":%llu,\"short_writes\":%llu,\"ok\":%d}}",
+                (t_end - t_start) / 1000.0, bytes, nsegs, (t_start - t_wait) / 1000.0,
+                (unsigned long long)retries, (unsigned long long)short_writes, ret == 0);
+    }
+    pthread_mutex_unlock(&disp->stats_lock);
+    return ret;
+}
+
+void ssd1306_stats_frame(ssd1306_t *disp, const ssd1306_flush_report_t *report, int result, uint64_t t0_ns) {
+    uint64_t t_end = ssd1306_now_ns();
+    uint64_t us = (t_end - t0_ns) / 1000;
+    uint32_t lat = us > UINT32_MAX ? UINT32_MAX : (uint32_t)us;
+
+    pthread_mutex_lock(&disp->stats_lock);
+    if (result == 0) {
+        disp->report = *report;
+    }
+    // Frames with nothing to send never touch the bus.
+    if (report->segs > 0) {
+        disp->stats.frames += result == 0;
+        disp->latency[ssd1306_latency_bucket(lat)]++;
+        if (lat > disp->latency_max_us) {
+            disp->latency_max_us = lat;
+        }
+        if (disp->trace) {
+            ssd1306_trace_begin(disp, "frame", "flush", "X", t0_ns);
+            fprintf(disp->trace, ",\"dur\":%.3f,\"args\":{\"plan\":\"%s\",\"bytes\":%zu,\"ok\":%d}}",
+                    (t_end - t0_ns) / 1000.0, plan_names[report->plan & 3],
+                    report->cmd_bytes + report->data_bytes, result == 0);
+        }
+    }
+    pthread_mutex_unlock(&disp->stats_lock);
+}
+
+void ssd1306_stats_event(ssd1306_t *disp, int event) {
+    uint64_t now = ssd1306_now_ns();
+    pthread_mutex_lock(&disp->stats_lock);
+    if (event == STATS_DROP) {
+        disp->stats.frames_dropped++;
+    } else {
+        disp->stats.flushes++;
+    }
+    if (disp->trace) {
+        ssd1306_trace_begin(disp, event == STATS_DROP ? "drop" : "flush", "app", "i", now);
+        fputs(",\"s\":\"t\"}", disp->trace);
+    }
+    pthread_mutex_unlock(&disp->stats_lock);
+}
+
+void ssd1306_get_stats(ssd1306_t *disp, ssd1306_stats_t *stats) {
+    pthread_mutex_lock(&disp->stats_lock);
+    *stats = disp->stats;
+    uint64_t total = 0;
+    for (unsigned i = 0; i < LATENCY_BUCKETS; i++) {
+        total += disp->latency[i];
+    }
+    stats->latency_p50_us = ssd1306_latency_percentile(disp, total, 50, 100);
+    stats->latency_p99_us = ssd1306_latency_percentile(disp, total, 99, 100);
+    stats->latency_max_us = disp->latency_max_us;
+    pthread_mutex_unlock(&disp->stats_lock);
+}
+
+void ssd1306_reset_stats(ssd1306_t *disp) {
+    pthread_mutex_lock(&disp->stats_lock);
+    memset(&disp->stats, 0, sizeof(disp->stats));
+    memset(disp->latency, 0, sizeof(disp->latency));
+    disp->latency_max_us = 0;
+    pthread_mutex_unlock(&disp->stats_lock);
+}
+
+int ssd1306_trace_start(ssd1306_t *disp, const char *path) {
+    FILE *fp = fopen(path, "w");
+    if (!fp) {
+        perror("ssd1306: Failed to open trace file");
+        return -1;
+    }
+    ssd1306_trace_stop(disp);
+
+    pthread_mutex_lock(&disp->stats_lock);
+    disp->trace = fp;
+    disp->trace_events = 0;
+    // Name the process row after the transport and its bus.
+    const char *bus = disp->ops->bus_id ? disp->ops->bus_id(disp->ctx) : NULL;
+    fputs("[\n", fp);
+    ssd1306_trace_begin(disp, "process_name", "__metadata", "M", 0);
+    fprintf(fp, ",\"args\":{\"name\":\"ssd1306 %s%s%s\"}}",
+            disp->ops->name ? disp->ops->name : "display", bus ? " " : "", bus ? bus : "");
+    pthread_mutex_unlock(&disp->stats_lock);
+    return 0;
+}
+
+void ssd1306_trace_stop(ssd1306_t *disp) {
+    pthread_mutex_lock(&disp->stats_lock);
+    if (disp->trace) {
+        fputs("\n]\n", disp->trace);
+        fclose(disp->trace);
+        disp->trace = NULL;
+    }
+    pthread_mutex_unlock(&disp->stats_lock);
+}
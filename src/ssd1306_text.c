@@ -0,0 +1,232 @@
+#include "ssd1306_internal.h"
+#include <string.h>
+
+// -------------------------------------------------
+// A simple 5x8 font for ASCII characters 32 to 126.
+// Each character is represented by 5 bytes.
+#define FONT_START 32
+#define FONT_END   126
+
+static const uint8_t font5x8[95][5] = {
+    /* Space (32) */  {0x00,0x00,0x00,0x00,0x00},
+    /* '!' (33)   */  {0x00,0x00,0x5F,0x00,0x00},
+    /* '"' (34)   */  {0x00,0x07,0x00,0x07,0x00},
+    /* '#' (35)   */  {0x14,0x7F,0x14,0x7F,0x14},
+    /* '$' (36)   */  {0x24,0x2A,0x7F,0x2A,0x12},
+    /* '%' (37)   */  {0x23,0x13,0x08,0x64,0x62},
+    /* '&' (38)   */  {0x36,0x49,0x55,0x22,0x50},
+    /* ''' (39)   */  {0x00,0x05,0x03,0x00,0x00},
+    /* '(' (40)   */  {0x00,0x1C,0x22,0x41,0x00},
+    /* ')' (41)   */  {0x00,0x41,0x22,0x1C,0x00},
+    /* '*' (42)   */  {0x14,0x08,0x3E,0x08,0x14},
+    /* '+' (43)   */  {0x08,0x08,0x3E,0x08,0x08},
+    /* ',' (44)   */  {0x00,0x50,0x30,0x00,0x00},
+    /* '-' (45)   */  {0x08,0x08,0x08,0x08,0x08},
+    /* '.' (46)   */  {0x00,0x60,0x60,0x00,0x00},
+    /* '/' (47)   */  {0x20,0x10,0x08,0x04,0x02},
+    /* '0' (48)   */  {0x3E,0x51,0x49,0x45,0x3E},
+    /* '1' (49)   */  {0x00,0x42,0x7F,0x40,0x00},
+    /* '2' (50)   */  {0x42,0x61,0x51,0x49,0x46},
+    /* '3' (51)   */  {0x21,0x41,0x45,0x4B,0x31},
+    /* '4' (52)   */  {0x18,0x14,0x12,0x7F,0x10},
+    /* '5' (53)   */  {0x27,0x45,0x45,0x45,0x39},
+    /* '6' (54)   */  {0x3C,0x4A,0x49,0x49,0x30},
+    /* '7' (55)   */  {0x01,0x71,0x09,0x05,0x03},
+    /* '8' (56)   */  {0x36,0x49,0x49,0x49,0x36},
+    /* '9' (57)   */  {0x06,0x49,0x49,0x29,0x1E},
+    /* ':' (58)   */  {0x00,0x36,0x36,0x00,0x00},
+    /* ';' (59)   */  {0x00,0x56,0x36,0x00,0x00},
+    /* '<' (60)   */  {0x08,0x14,0x22,0x41,0x00},
+    /* '=' (61)   */  {0x14,0x14,0x14,0x14,0x14},
+    /* '>' (62)   */  {0x00,0x41,0x22,0x14,0x08},
+    /* '?' (63)   */  {0x02,0x01,0x51,0x09,0x06},
+    /* '@' (64)   */  {0x32,0x49,0x79,0x41,0x3E},
+    /* 'A' (65)   */  {0x7E,0x11,0x11,0x11,0x7E},
+    /* 'B' (66)   */  {0x7F,0x49,0x49,0x49,0x36},
+    /* 'C' (67)   */  {0x3E,0x41,0x41,0x41,0x22},
+    /* 'D' (68)   */  {0x7F,0x41,0x41,0x22,0x1C},
+    /* 'E' (69)   */  {0x7F,0x49,0x49,0x49,0x41},
+    /* 'F' (70)   */  {0x7F,0x09,0x09,0x09,0x01},
+    /* 'G' (71)   */  {0x3E,0x41,0x49,0x49,0x7A},
+    /* 'H' (72)   */  {0x7F,0x08,0x08,0x08,0x7F},
+    /* 'I' (73)   */  {0x00,0x41,0x7F,0x41,0x00},
+    /* 'J' (74)   */  {0x20,0x40,0x41,0x3F,0x01},
+    /* 'K' (75)   */  {0x7F,0x08,0x14,0x22,0x41},
+    /* 'L' (76)   */  {0x7F,0x40,0x40,0x40,0x40},
+    /* 'M' (77)   */  {0x7F,0x02,0x04,0x02,0x7F},
+    /* 'N' (78)   */  {0x7F,0x04,0x08,0x10,0x7F},
+    /* 'O' (79)   */  {0x3E,0x41,0x41,0x41,0x3E},
+    /* 'P' (80)   */  {0x7F,0x09,0x09,0x09,0x06},
+    /* 'Q' (81)   */  {0x3E,0x41,0x51,0x21,0x5E},
+    /* 'R' (82)   */  {0x7F,0x09,0x19,0x29,0x46},
+    /* 'S' (83)   */  {0x46,0x49,0x49,0x49,0x31},
+    /* 'T' (84)   */  {0x01,0x01,0x7F,0x01,0x01},
+    /* 'U' (85)   */  {0x3F,0x40,0x40,0x40,0x3F},
+    /* 'V' (86)   */  {0x1F,0x20,0x40,0x20,0x1F},
+    /* 'W' (87)   */  {0x3F,0x40,0x38,0x40,0x3F},
+    /* 'X' (88)   */  {0x63,0x14,0x08,0x14,0x63},
+    /* 'Y' (89)   */  {0x07,0x08,0x70,0x08,0x07},
+    /* 'Z' (90)   */  {0x61,0x51,0x49,0x45,0x43},
+    /* '[' (91)   */  {0x00,0x7F,0x41,0x41,0x00},
+    /* '\' (92)   */  {0x02,0x04,0x08,0x10,0x20},
+    /* ']' (93)   */  {0x00,0x41,0x41,0x7F,0x00},
+    /* '^' (94)   */  {0x04,0x02,0x01,0x02,0x04},
+    /* '_' (95)   */  {0x40,0x40,0x40,0x40,0x40},
+    /* '`' (96)   */  {0x00,0x03,0x07,0x00,0x00},
+    /* 'a' (97)   */  {0x20,0x54,0x54,0x54,0x78},
+    /* 'b' (98)   */  {0x7F,0x48,0x44,0x44,0x38},
+    /* 'c' (99)   */  {0x38,0x44,0x44,0x44,0x20},
+    /* 'd' (100)  */  {0x38,0x44,0x44,0x48,0x7F},
+    /* 'e' (101)  */  {0x38,0x54,0x54,0x54,0x18},
+    /* 'f' (102)  */  {0x08,0x7E,0x09,0x01,0x02},
+    /* 'g' (103)  */  {0x0C,0x52,0x52,0x52,0x3E},
+    /* 'h' (104)  */  {0x7F,0x08,0x04,0x04,0x78},
+    /* 'i' (105)  */  {0x00,0x44,0x7D,0x40,0x00},
+    /* 'j' (106)  */  {0x20,0x40,0x44,0x3D,0x00},
+    /* 'k' (107)  */  {0x7F,0x10,0x28,0x44,0x00},
+    /* 'l' (108)  */  {0x00,0x41,0x7F,0x40,0x00},
+    /* 'm' (109)  */  {0x7C,0x04,0x18,0x04,0x78},
+    /* 'n' (110)  */  {0x7C,0x08,0x04,0x04,0x78},
+    /* 'o' (111)  */  {0x38,0x44,0x44,0x44,0x38},
+    /* 'p' (112)  */  {0x7C,0x14,0x14,0x14,0x08},
+    /* 'q' (113)  */  {0x08,0x14,0x14,0x18,0x7C},
+    /* 'r' (114)  */  {0x7C,0x08,0x04,0x04,0x08},
+    /* 's' (115)  */  {0x48,0x54,0x54,0x54,0x20},
+    /* 't' (116)  */  {0x04,0x3F,0x44,0x40,0x20},
+    /* 'u' (117)  */  {0x3C,0x40,0x40,0x20,0x7C},
+    /* 'v' (118)  */  {0x1C,0x20,0x40,0x20,0x1C},
+    /* 'w' (119)  */  {0x3C,0x40,0x30,0x40,0x3C},
+    /* 'x' (120)  */  {0x44,0x28,0x10,0x28,0x44},
+    /* 'y' (121)  */  {0x0C,0x50,0x50,0x50,0x3C},
+    /* 'z' (122)  */  {0x44,0x64,0x54,0x4C,0x44},
+    /* '{' (123)  */  {0x00,0x08,0x36,0x41,0x00},
+    /* '|' (124)  */  {0x00,0x00,0x7F,0x00,0x00},
+    /* '}' (125)  */  {0x00,0x41,0x36,0x08,0x00},
+    /* '~' (126)  */  {0x08,0x04,0x08,0x10,0x08}
+};
+
+// Columns per rendered character: 5 font columns plus 1 blank spacing column.
+#define GLYPH_COLS 6
+
+// Private helper: expand one character into GLYPH_COLS columns.
+static void ssd1306_render_glyph(uint8_t *out, char c) {
+    if (c < FONT_START || c > FONT_END) {
+        c = ' '; // Replace unsupported characters with space
+    }
+    memcpy(out, font5x8[c - FONT_START], 5);
+    out[5] = 0x00;
+}
+
+// Private helper: expand a run of up to TEXT_RUN_CHARS characters into one
+// contiguous column buffer. Recently rendered runs come from the cache, so
+// labels redrawn every refresh are not expanded again.
+static const uint8_t *ssd1306_text_run(ssd1306_t *disp, const char *str, size_t len) {
+    ssd1306_text_run_t *victim = &disp->text_cache[0];
+    uint32_t now = ++disp->text_clock;
+
+    for (int i = 0; i < TEXT_CACHE_SIZE; i++) {
+        ssd1306_text_run_t *run = &disp->text_cache[i];
+        if (run->len == len && memcmp(run->str, str, len) == 0) {
+            run->used = now;
+            return run->cols;
+        }
+        if (run->used < victim->used) {
+            victim = run;
+        }
+    }
+
+    memcpy(victim->str, str, len);
+    victim->len = (uint8_t)len;
+    victim->used = now;
+    for (size_t i = 0; i < len; i++) {
+        ssd1306_render_glyph(&victim->cols[i * GLYPH_COLS], str[i]);
+    }
+    return victim->cols;
+}
+
+// Private helper: copy columns to the cursor and advance it, wrapping to the
+// next page the way horizontal addressing mode does.
+static void ssd1306_blit_cursor(ssd1306_t *disp, const uint8_t *cols, size_t n) {
+    while (n > 0) {
+        size_t room = disp->geom.width - disp->col;
+        size_t k = n < room ? n : room;
+        memcpy(&disp->fb[disp->page][disp->col], cols, k);
+        ssd1306_mark_dirty(disp, disp->page, disp->col, (uint8_t)(disp->col + k - 1));
+        cols += k;
+        n -= k;
+        disp->col += k;
+        if (disp->col == disp->geom.width) {
+            disp->col = 0;
+            disp->page = (uint8_t)((disp->page + 1) % disp->pages);
+        }
+    }
+}
+
+void ssd1306_blit_strip(ssd1306_t *disp, int x, int y, const uint8_t *cols, size_t n) {
+    if (x < 0) {
+        if ((size_t)-x >= n) {
+            return;
+        }
+        cols += -x;
+        n -= (size_t)-x;
+        x = 0;
+    }
+    if (x >= disp->geom.width || n == 0) {
+        return;
+    }
+    if (n > (size_t)(disp->geom.width - x)) {
+        n = (size_t)(disp->geom.width - x);
+    }
+
+    int page = y >= 0 ? y / 8 : -((7 - y) / 8);
+    int shift = y - page * 8;
+    uint8_t x0 = (uint8_t)x, x1 = (uint8_t)(x + n - 1);
+
+    if (shift == 0) {
+        if (page >= 0 && page < disp->pages) {
+            memcpy(&disp->fb[page][x0], cols, n);
+            ssd1306_mark_dirty(disp, (uint8_t)page, x0, x1);
+        }
+        return;
+    }
+    if (page >= 0 && page < disp->pages) {
+        uint8_t keep = (uint8_t)~(0xFF << shift);
+        uint8_t *row = &disp->fb[page][x0];
+        for (size_t i = 0; i < n; i++) {
+            row[i] = (row[i] & keep) | (uint8_t)(cols[i] << shift);
+        }
+        ssd1306_mark_dirty(disp, (uint8_t)page, x0, x1);
+    }
+    if (page + 1 >= 0 && page + 1 < disp->pages) {
+        uint8_t keep = (uint8_t)(0xFF << shift);
+        uint8_t *row = &disp->fb[page + 1][x0];
+        for (size_t i = 0; i < n; i++) {
+            row[i] = (row[i] & keep) | (uint8_t)(cols[i] >> (8 - shift));
+        }
+        ssd1306_mark_dirty(disp, (uint8_t)(page + 1), x0, x1);
+    }
+}
+
+void ssd1306_draw_char(ssd1306_t *disp, char c) {
+    uint8_t cols[GLYPH_COLS];
+    ssd1306_render_glyph(cols, c);
+    ssd1306_blit_cursor(disp, cols, GLYPH_COLS);
+}
+
+void ssd1306_draw_string(ssd1306_t *disp, const char *str) {
+    while (*str) {
+        size_t len = strnlen(str, TEXT_RUN_CHARS);
+        ssd1306_blit_cursor(disp, ssd1306_text_run(disp, str, len), len * GLYPH_COLS);
+        str += len;
+    }
+}
+
+int ssd1306_draw_text(ssd1306_t *disp, int x, int y, const char *str) {
+    while (*str) {
+        size_t len = strnlen(str, TEXT_RUN_CHARS);
+        ssd1306_blit_strip(disp, x, y, ssd1306_text_run(disp, str, len), len * GLYPH_COLS);
+        x += (int)(len * GLYPH_COLS);
+        str += len;
+    }
+    return x;
+}
@@ -0,0 +1,129 @@
+#include "ssd1306_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// -------------------------------------------------
+// Callback transport: hands every segment to a user function.
+
+typedef struct {
+    ssd1306_write_fn write;
+    void *user;
+} ssd1306_callback_t;
+
+static int ssd1306_callback_xfer(void *ctx, const ssd1306_seg_t *segs, size_t nsegs) {
+    ssd1306_callback_t *cb = ctx;
+    for (size_t i = 0; i < nsegs; i++) {
+        if (segs[i].len > 0 && cb->write(cb->user, segs[i].ctrl, segs[i].buf, segs[i].len) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void ssd1306_callback_close(void *ctx) {
+    free(ctx);
+}
+
+static const ssd1306_transport_ops_t ssd1306_callback_ops = {
+    .name = "callback",
+    .xfer = ssd1306_callback_xfer,
+    .close = ssd1306_callback_close,
+};
+
+ssd1306_t *ssd1306_init_callback(ssd1306_write_fn write, void *user) {
+    ssd1306_callback_t *cb = calloc(1, sizeof(*cb));
+    if (!cb) {
+        perror("ssd1306: Failed to allocate callback transport");
+        return NULL;
+    }
+    cb->write = write;
+    cb->user = user;
+    return ssd1306_init_transport(&ssd1306_callback_ops, cb);
+}
+
+// -------------------------------------------------
+// Memory transport: records every byte and transfer, for tests and benchmarks.
+
+typedef struct {
+    ssd1306_mem_log_t log;
+    size_t bytes_cap;
+    size_t segs_cap;
+} ssd1306_mem_t;
+
+// Private helper: grow a log array to hold at least n elements.
+static int ssd1306_mem_grow(void **array, size_t *cap, size_t n, size_t elem) {
+    if (n <= *cap) {
+        return 0;
+    }
+    size_t new_cap = *cap ? *cap : 256;
+    while (new_cap < n) {
+        new_cap *= 2;
+    }
+    void *p = realloc(*array, new_cap * elem);
+    if (!p) {
+        perror("ssd1306: Failed to grow memory transport log");
+        return -1;
+    }
+    *array = p;
+    *cap = new_cap;
+    return 0;
+}
+
+static int ssd1306_mem_xfer(void *ctx, const ssd1306_seg_t *segs, size_t nsegs) {
+    ssd1306_mem_t *mem = ctx;
+    ssd1306_mem_log_t *log = &mem->log;
+    for (size_t i = 0; i < nsegs; i++) {
+        if (segs[i].len == 0) {
+            continue;
+        }
+        if (ssd1306_mem_grow((void **)&log->bytes, &mem->bytes_cap, log->nbytes + segs[i].len, 1) < 0 ||
+            ssd1306_mem_grow((void **)&log->segs, &mem->segs_cap, log->nsegs + 1, sizeof(*log->segs)) < 0) {
+            return -1;
+        }
+        log->segs[log->nsegs++] = (ssd1306_mem_seg_t){ segs[i].ctrl, log->nbytes, segs[i].len, log->xfers };
+        memcpy(log->bytes + log->nbytes, segs[i].buf, segs[i].len);
+        log->nbytes += segs[i].len;
+    }
+    log->xfers++;
+    return 0;
+}
+
+static void ssd1306_mem_close(void *ctx) {
+    ssd1306_mem_t *mem = ctx;
+    free(mem->log.bytes);
+    free(mem->log.segs);
+    free(mem);
+}
+
+static const ssd1306_transport_ops_t ssd1306_mem_ops = {
+    .name = "mem",
+    .xfer = ssd1306_mem_xfer,
+    .close = ssd1306_mem_close,
+};
+
+ssd1306_t *ssd1306_init_mem(void) {
+    ssd1306_mem_t *mem = calloc(1, sizeof(*mem));
+    if (!mem) {
+        perror("ssd1306: Failed to allocate memory transport");
+        return NULL;
+    }
+    return ssd1306_init_transport(&ssd1306_mem_ops, mem);
+}
+
+const ssd1306_mem_log_t *ssd1306_mem_log(const ssd1306_t *disp) {
+    if (disp->ops != &ssd1306_mem_ops) {
+        return NULL;
+    }
+    return &((ssd1306_mem_t *)disp->ctx)->log;
+}
+
+void ssd1306_mem_reset(ssd1306_t *disp) {
+    if (disp->ops != &ssd1306_mem_ops) {
+        return;
+    }
+    ssd1306_mem_log_t *log = &((ssd1306_mem_t *)disp->ctx)->log;
+    log->nbytes = 0;
+    log->nsegs = 0;
+    log->xfers = 0;
+}
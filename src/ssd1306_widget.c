@@ -0,0 +1,395 @@
+#include "ssd1306_internal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Longest label text, and most character cells of a readout.
+#define WIDGET_TEXT_MAX    32
+#define WIDGET_READOUT_MAX 16
+
+enum { WIDGET_LABEL, WIDGET_BAR, WIDGET_SPARKLINE, WIDGET_READOUT };
+
+struct ssd1306_widget {
+    ssd1306_ui_t *ui;
+    int kind;                          // WIDGET_*.
+    int x, y, w, h;
+    int redraw;                        // Whole widget must be repainted: new, invalidated.
+    int changed;                       // Value changed since the last render.
+    const ssd1306_font_t *font;        // Labels and readouts; NULL for the built-in 5x8 font.
+    char text[WIDGET_TEXT_MAX + 1];    // Labels and readouts: what to show,
+    char shown[WIDGET_TEXT_MAX + 1];   // and what the framebuffer holds.
+    int text_end;                      // Labels: column just past the drawn text.
+    int cell, cells, decimals;         // Readouts: cell width and count, fixed decimals.
+    int min, max;                      // Bars and sparklines: value range.
+    int value, filled;                 // Bars: value, and pixels drawn filled.
+    int *history;                      // Sparklines: ring of w samples,
+    unsigned long pushed, fresh;       // samples pushed in all and since the last render.
+    int sweep;
+};
+
+struct ssd1306_ui {
+    ssd1306_t *disp;
+    ssd1306_widget_t **widgets;
+    size_t count, cap;
+};
+
+ssd1306_ui_t *ssd1306_ui_create(ssd1306_t *disp) {
+    ssd1306_ui_t *ui = calloc(1, sizeof(*ui));
+    if (!ui) {
+        perror("ssd1306: Failed to allocate widget set");
+        return NULL;
+    }
+    ui->disp = disp;
+    return ui;
+}
+
+void ssd1306_ui_destroy(ssd1306_ui_t *ui) {
+    if (!ui) {
+        return;
+    }
+    for (size_t i = 0; i < ui->count; i++) {
+        free(ui->widgets[i]->history);
+        free(ui->widgets[i]);
+    }
+    free(ui->widgets);
+    free(ui);
+}
+
+// Private helper: allocate a widget and add it to the set.
+static ssd1306_widget_t *ssd1306_widget_add(ssd1306_ui_t *ui, int kind, int x, int y, int w, int h) {
+    if (w <= 0 || h <= 0) {
+        return NULL;
+    }
+    if (ui->count == ui->cap) {
+        size_t cap = ui->cap ? ui->cap * 2 : 16;
+        ssd1306_widget_t **widgets = realloc(ui->widgets, cap * sizeof(*widgets));
+        if (!widgets) {
+            perror("ssd1306: Failed to allocate widget");
+            return NULL;
+        }
+        ui->widgets = widgets;
+        ui->cap = cap;
+    }
+    ssd1306_widget_t *wd = calloc(1, sizeof(*wd));
+    if (!wd) {
+        perror("ssd1306: Failed to allocate widget");
+        return NULL;
+    }
+    *wd = (ssd1306_widget_t){ .ui = ui, .kind = kind, .x = x, .y = y, .w = w, .h = h, .redraw = 1 };
+    ui->widgets[ui->count++] = wd;
+    return wd;
+}
+
+void ssd1306_widget_destroy(ssd1306_widget_t *wd) {
+    if (!wd) {
+        return;
+    }
+    ssd1306_ui_t *ui = wd->ui;
+    ssd1306_fill_rect(ui->disp, wd->x, wd->y, wd->w, wd->h, SSD1306_BLACK);
+    size_t i = 0;
+    while (ui->widgets[i] != wd) {
+        i++;
+    }
+    memmove(&ui->widgets[i], &ui->widgets[i + 1], (ui->count - i - 1) * sizeof(wd));
+    ui->count--;
+    free(wd->history);
+    free(wd);
+}
+
+void ssd1306_widget_invalidate(ssd1306_widget_t *wd) {
+    wd->redraw = 1;
+}
+
+// -------------------------------------------------
+// Text
+
+static int ssd1306_font_height(const ssd1306_font_t *font) {
+    return font ? font->height : 8;
+}
+
+static int ssd1306_char_width(const ssd1306_font_t *font, char c) {
+    char s[2] = { c, '\0' };
+    return font ? ssd1306_text_width(font, s) : 6;
+}
+
+// Private helper: draw n characters of str at (x, y), opaque over the
+// height of the font.
+static void ssd1306_widget_text(ssd1306_widget_t *wd, int x, const char *str, size_t n) {
+    char buf[WIDGET_TEXT_MAX + 1];
+    memcpy(buf, str, n);
+    buf[n] = '\0';
+    if (wd->font) {
+        ssd1306_draw_text_font(wd->ui->disp, wd->font, x, wd->y, buf);
+    } else {
+        ssd1306_draw_text(wd->ui->disp, x, wd->y, buf);
+    }
+}
+
+ssd1306_widget_t *ssd1306_label_create(ssd1306_ui_t *ui, int x, int y, int w, const ssd1306_font_t *font) {
+    ssd1306_widget_t *wd = ssd1306_widget_add(ui, WIDGET_LABEL, x, y, w, ssd1306_font_height(font));
+    if (wd) {
+        wd->font = font;
+        wd->text_end = x;
+    }
+    return wd;
+}
+
+void ssd1306_label_set(ssd1306_widget_t *wd, const char *text) {
+    if (strncmp(wd->text, text, WIDGET_TEXT_MAX) != 0) {
+        strncpy(wd->text, text, WIDGET_TEXT_MAX);
+        wd->changed = 1;
+    }
+}
+
+// Private helper: redraw a label from its first changed character on, and
+// clear whatever the old text covered past the end of the new one. Only
+// fully visible characters count, so nothing is drawn or cleared past the
+// label's width.
+static void ssd1306_label_render(ssd1306_widget_t *wd) {
+    size_t same = 0;
+    int x = wd->x, right = wd->x + wd->w;
+    if (!wd->redraw) {
+        while (wd->text[same] && wd->text[same] == wd->shown[same] &&
+               x + ssd1306_char_width(wd->font, wd->text[same]) <= right) {
+            x += ssd1306_char_width(wd->font, wd->text[same++]);
+        }
+    }
+    int end = x;
+    size_t n = same;
+    while (wd->text[n] && end + ssd1306_char_width(wd->font, wd->text[n]) <= right) {
+        end += ssd1306_char_width(wd->font, wd->text[n++]);
+    }
+    ssd1306_widget_text(wd, x, wd->text + same, n - same);
+
+    int old_end = wd->redraw || wd->text_end > right ? right : wd->text_end;
+    if (old_end > end) {
+        ssd1306_fill_rect(wd->ui->disp, end, wd->y, old_end - end, wd->h, SSD1306_BLACK);
+    }
+    wd->text_end = end;
+    memcpy(wd->shown, wd->text, sizeof(wd->shown));
+}
+
+ssd1306_widget_t *ssd1306_readout_create(ssd1306_ui_t *ui, int x, int y, int cells, int decimals,
+                                         const ssd1306_font_t *font) {
+    if (cells <= 0 || cells > WIDGET_READOUT_MAX || decimals < 0 || decimals >= cells) {
+        return NULL;
+    }
+    // Every cell is as wide as the widest glyph a number uses, so digits
+    // keep their place as the value changes.
+    int cell = 0;
+    for (const char *c = "0123456789-."; *c; c++) {
+        int cw = ssd1306_char_width(font, *c);
+        cell = cw > cell ? cw : cell;
+    }
+    ssd1306_widget_t *wd = ssd1306_widget_add(ui, WIDGET_READOUT, x, y, cells * cell, ssd1306_font_height(font));
+    if (wd) {
+        wd->font = font;
+        wd->cell = cell;
+        wd->cells = cells;
+        wd->decimals = decimals;
+        memset(wd->text, ' ', (size_t)cells);
+    }
+    return wd;
+}
+
+void ssd1306_readout_set(ssd1306_widget_t *wd, long value) {
+    char num[32], text[WIDGET_TEXT_MAX + 1];
+    unsigned long mag = value < 0 ? 0UL - (unsigned long)value : (unsigned long)value, scale = 1;
+    for (int i = 0; i < wd->decimals; i++) {
+        scale *= 10;
+    }
+    if (wd->decimals) {
+        snprintf(num, sizeof(num), "%s%lu.%0*lu", value < 0 ? "-" : "", mag / scale, wd->decimals, mag % scale);
+    } else {
+        snprintf(num, sizeof(num), "%ld", value);
+    }
+    // Right-aligned; a value that does not fit shows as dashes.
+    int len = (int)strlen(num);
+    if (len > wd->cells) {
+        memset(text, '-', (size_t)wd->cells);
+    } else {
+        memset(text, ' ', (size_t)(wd->cells - len));
+        memcpy(text + wd->cells - len, num, (size_t)len);
+    }
+    text[wd->cells] = '\0';
+    if (strcmp(wd->text, text) != 0) {
+        memcpy(wd->text, text, (size_t)wd->cells + 1);
+        wd->changed = 1;
+    }
+}
+
+// Private helper: redraw the cells whose character changed, each glyph
+// centered in its cell.
+static void ssd1306_readout_render(ssd1306_widget_t *wd) {
+    for (int i = 0; i < wd->cells; i++) {
+        char c = wd->text[i];
+        if (!wd->redraw && c == wd->shown[i]) {
+            continue;
+        }
+        int cx = wd->x + i * wd->cell;
+        ssd1306_fill_rect(wd->ui->disp, cx, wd->y, wd->cell, wd->h, SSD1306_BLACK);
+        if (c != ' ') {
+            ssd1306_widget_text(wd, cx + (wd->cell - ssd1306_char_width(wd->font, c)) / 2, &c, 1);
+        }
+    }
+    memcpy(wd->shown, wd->text, sizeof(wd->shown));
+}
+
+// -------------------------------------------------
+// Bars and sparklines
+
+// Private helper: map a value into 0..span, clamped to the widget's range.
+static int ssd1306_widget_scale(const ssd1306_widget_t *wd, int value, int span) {
+    if (value <= wd->min) {
+        return 0;
+    }
+    if (value >= wd->max) {
+        return span;
+    }
+    return (int)((long long)(value - wd->min) * span / (wd->max - wd->min));
+}
+
+ssd1306_widget_t *ssd1306_bar_create(ssd1306_ui_t *ui, int x, int y, int w, int h, int min, int max) {
+    if (max <= min) {
+        return NULL;
+    }
+    ssd1306_widget_t *wd = ssd1306_widget_add(ui, WIDGET_BAR, x, y, w, h);
+    if (wd) {
+        wd->min = min;
+        wd->max = max;
+        wd->value = min;
+    }
+    return wd;
+}
+
+void ssd1306_bar_set(ssd1306_widget_t *wd, int value) {
+    if (wd->value != value) {
+        wd->value = value;
+        wd->changed = 1;
+    }
+}
+
+// Private helper: fill or clear the part of a bar from one length to
+// another; bars taller than wide grow upwards.
+static void ssd1306_bar_span(ssd1306_widget_t *wd, int from, int to, int color) {
+    if (wd->h > wd->w) {
+        ssd1306_fill_rect(wd->ui->disp, wd->x, wd->y + wd->h - to, wd->w, to - from, color);
+    } else {
+        ssd1306_fill_rect(wd->ui->disp, wd->x + from, wd->y, to - from, wd->h, color);
+    }
+}
+
+// Private helper: paint only the stretch between the old and the new
+// length, filling it as the bar grows and clearing it as it shrinks.
+static void ssd1306_bar_render(ssd1306_widget_t *wd) {
+    int len = wd->h > wd->w ? wd->h : wd->w;
+    int filled = ssd1306_widget_scale(wd, wd->value, len);
+    if (wd->redraw) {
+        ssd1306_bar_span(wd, 0, filled, SSD1306_WHITE);
+        ssd1306_bar_span(wd, filled, len, SSD1306_BLACK);
+    } else if (filled > wd->filled) {
+        ssd1306_bar_span(wd, wd->filled, filled, SSD1306_WHITE);
+    } else if (filled < wd->filled) {
+        ssd1306_bar_span(wd, filled, wd->filled, SSD1306_BLACK);
+    }
+    wd->filled = filled;
+}
+
+ssd1306_widget_t *ssd1306_sparkline_create(ssd1306_ui_t *ui, int x, int y, int w, int h, int min, int max,
+                                           int flags) {
+    if (max <= min || w <= 1) {
+        return NULL;
+    }
+    int *history = calloc((size_t)w, sizeof(*history));
+    if (!history) {
+        perror("ssd1306: Failed to allocate sparkline");
+        return NULL;
+    }
+    ssd1306_widget_t *wd = ssd1306_widget_add(ui, WIDGET_SPARKLINE, x, y, w, h);
+    if (!wd) {
+        free(history);
+        return NULL;
+    }
+    wd->min = min;
+    wd->max = max;
+    wd->history = history;
+    wd->sweep = (flags & SSD1306_SPARK_SWEEP) != 0;
+    return wd;
+}
+
+void ssd1306_sparkline_push(ssd1306_widget_t *wd, int value) {
+    wd->history[wd->pushed++ % (unsigned long)wd->w] = value;
+    wd->fresh++;
+    wd->changed = 1;
+}
+
+// Private helper: draw sample k in column col, joined by a vertical run to
+// the previous sample when it is still kept (k > first).
+static void ssd1306_spark_column(ssd1306_widget_t *wd, int col, unsigned long k, unsigned long first) {
+    int span = wd->h - 1, bottom = wd->y + span;
+    int r1 = bottom - ssd1306_widget_scale(wd, wd->history[k % (unsigned long)wd->w], span), r0 = r1;
+    if (k > first) {
+        r0 = bottom - ssd1306_widget_scale(wd, wd->history[(k - 1) % (unsigned long)wd->w], span);
+    }
+    ssd1306_fill_rect(wd->ui->disp, col, wd->y, 1, wd->h, SSD1306_BLACK);
+    ssd1306_draw_vline(wd->ui->disp, col, r0 < r1 ? r0 : r1, (r0 < r1 ? r1 - r0 : r0 - r1) + 1, SSD1306_WHITE);
+}
+
+// Private helper: a scrolling sparkline redraws every column, newest on
+// the right. A sweeping one only draws the new samples where they land,
+// wrapping around, with a blank column ahead of the newest to show the
+// boundary, so a sample costs a column or two on the bus.
+static void ssd1306_sparkline_render(ssd1306_widget_t *wd) {
+    unsigned long w = (unsigned long)wd->w, n = wd->pushed;
+    if (!wd->sweep) {
+        unsigned long first = n > w ? n - w : 0;
+        if (wd->redraw && n < w) {
+            ssd1306_fill_rect(wd->ui->disp, wd->x, wd->y, (int)(w - n), wd->h, SSD1306_BLACK);
+        }
+        for (unsigned long k = first; k < n; k++) {
+            ssd1306_spark_column(wd, wd->x + (int)(w - (n - k)), k, first);
+        }
+        return;
+    }
+    // The column ahead of the newest sample is the gap, so the oldest
+    // sample kept is not shown, but the next one still joins it.
+    unsigned long kept = n > w ? n - w : 0, from = n >= w ? n - w + 1 : 0;
+    if (wd->redraw) {
+        ssd1306_fill_rect(wd->ui->disp, wd->x, wd->y, wd->w, wd->h, SSD1306_BLACK);
+    } else if (wd->fresh < n - from) {
+        from = n - wd->fresh;
+    }
+    for (unsigned long k = from; k < n; k++) {
+        ssd1306_spark_column(wd, wd->x + (int)(k % w), k, kept);
+    }
+    ssd1306_fill_rect(wd->ui->disp, wd->x + (int)(n % w), wd->y, 1, wd->h, SSD1306_BLACK);
+}
+
+int ssd1306_ui_render(ssd1306_ui_t *ui) {
+    int rendered = 0;
+    for (size_t i = 0; i < ui->count; i++) {
+        ssd1306_widget_t *wd = ui->widgets[i];
+        if (!wd->redraw && !wd->changed) {
+            continue;
+        }
+        switch (wd->kind) {
+        case WIDGET_LABEL:
+            ssd1306_label_render(wd);
+            break;
+        case WIDGET_READOUT:
+            ssd1306_readout_render(wd);
+            break;
+        case WIDGET_BAR:
+            ssd1306_bar_render(wd);
+            break;
+        case WIDGET_SPARKLINE:
+            ssd1306_sparkline_render(wd);
+            wd->fresh = 0;
+            break;
+        }
+        wd->redraw = 0;
+        wd->changed = 0;
+        rendered++;
+    }
+    return rendered;
+}
@@ -0,0 +1,408 @@
+// bench: replay representative workloads through the memory transport and
+// model what they would cost on real buses.
+//
+// Every workload runs twice, with the encoder tuned for I2C and for SPI.
+// The recorded segments are then split into bus messages and system calls
+// the way the I2C and spidev transports split them, and timed at 100 kHz,
+// 400 kHz and 1 MHz I2C and 8 MHz SPI. No panel is needed.
+//
+// A third run sends the workload to the controller emulator and checks that
+// the controller RAM and start line end up matching the framebuffer, which
+// catches encoder bugs the byte counts cannot.
+//
+// Usage: bench [-o dir]
+//   -o: save the emulated picture of every workload as dir/<workload>.pbm
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ssd1306.h"
+
+// Transport limits (src/ssd1306_i2c.c, src/ssd1306_spi.c).
+#define I2C_MAX_MSG     8192   // Bytes per I2C message, control byte included.
+#define I2C_RDWR_MSGS   42     // Messages per I2C_RDWR ioctl.
+#define SPI_MAX_MSG     4096   // Bytes per SPI_IOC_MESSAGE.
+#define SPI_MAX_XFERS   16     // Transfers per SPI_IOC_MESSAGE.
+#define SPI_HZ          8000000
+
+// Bus metrics of one workload.
+typedef struct {
+    unsigned long frames;
+    unsigned long payload;     // Command and data bytes, without control bytes.
+    unsigned long xfers;       // Library transfers.
+    unsigned long wire;        // Bytes on the wire.
+    unsigned long msgs;        // I2C messages or SPI transfers.
+    unsigned long syscalls;    // ioctls, plus D/C switches on SPI.
+    unsigned long bits;        // Bus clocks.
+} bench_result_t;
+
+typedef void (*workload_fn)(ssd1306_t *disp, unsigned long *frames);
+
+// Private helper: count one flush of a workload.
+static void flush(ssd1306_t *disp, unsigned long *frames) {
+    ssd1306_flush(disp);
+    (*frames)++;
+}
+
+// -------------------------------------------------
+// Workloads. Each starts from a freshly initialized, flushed display.
+
+// Clear a screen full of text.
+static void work_clear(ssd1306_t *disp, unsigned long *frames) {
+    for (uint8_t page = 0; page < SSD1306_PAGES; page++) {
+        ssd1306_set_cursor(disp, page, 0);
+        ssd1306_draw_string(disp, "The quick brown fox j");
+    }
+    ssd1306_flush(disp);
+    ssd1306_mem_reset(disp);
+    ssd1306_clear_display(disp);
+    flush(disp, frames);
+}
+
+// Fill the screen with text, then replace every line.
+static void work_text(ssd1306_t *disp, unsigned long *frames) {
+    for (int round = 0; round < 2; round++) {
+        for (uint8_t page = 0; page < SSD1306_PAGES; page++) {
+            ssd1306_set_cursor(disp, page, 0);
+            ssd1306_draw_string(disp, round ? "jumps over a lazy dog" : "The quick brown fox j");
+        }
+        flush(disp, frames);
+    }
+}
+
+// The cpu_usage dashboard: a label and a bar per core, once a second.
+static void work_dashboard(ssd1306_t *disp, unsigned long *frames) {
+    unsigned seed = 1;
+    for (int tick = 0; tick < 60; tick++) {
+        for (uint8_t core = 0; core < 4; core++) {
+            seed = seed * 1103515245 + 12345;
+            int usage = (int)((seed >> 16) % 101);
+            char label[16];
+            snprintf(label, sizeof(label), "C%d:%3d%%", core, usage);
+            ssd1306_set_cursor(disp, core, 0);
+            ssd1306_draw_string(disp, label);
+            int bar = usage * 80 / 100;
+            ssd1306_fill_rect(disp, 40, core * 8, bar, 8, SSD1306_WHITE);
+            ssd1306_fill_rect(disp, 40 + bar, core * 8, 80 - bar, 8, SSD1306_BLACK);
+        }
+        flush(disp, frames);
+    }
+}
+
+// The same dashboard built from widgets, as examples/cpu_usage.c now does.
+static void work_widgets(ssd1306_t *disp, unsigned long *frames) {
+    ssd1306_ui_t *ui = ssd1306_ui_create(disp);
+    if (!ui) {
+        return;
+    }
+    ssd1306_widget_t *text[4], *bar[4];
+    for (int core = 0; core < 4; core++) {
+        char name[8];
+        snprintf(name, sizeof(name), "C%d", core);
+        ssd1306_label_set(ssd1306_label_create(ui, 0, core * 8, 12, NULL), name);
+        text[core] = ssd1306_readout_create(ui, 14, core * 8, 3, 0, NULL);
+        ssd1306_label_set(ssd1306_label_create(ui, 32, core * 8, 6, NULL), "%");
+        bar[core] = ssd1306_bar_create(ui, 40, core * 8, 80, 7, 0, 100);
+    }
+    unsigned seed = 1;
+    for (int tick = 0; tick < 60; tick++) {
+        for (int core = 0; core < 4; core++) {
+            seed = seed * 1103515245 + 12345;
+            int usage = (int)((seed >> 16) % 101);
+            ssd1306_readout_set(text[core], usage);
+            ssd1306_bar_set(bar[core], usage);
+        }
+        ssd1306_ui_render(ui);
+        flush(disp, frames);
+    }
+    ssd1306_ui_destroy(ui);
+}
+
+// Snake frames the way examples/snake.c draws them: clear, redraw, flush.
+static void work_snake(ssd1306_t *disp, unsigned long *frames) {
+    int xs[8], ys[8];
+    for (int i = 0; i < 8; i++) {
+        xs[i] = 10 - i;
+        ys[i] = 5;
+    }
+    for (int tick = 0; tick < 200; tick++) {
+        // Walk a rectangle around the grid.
+        int x = xs[0], y = ys[0];
+        if (y == 5 && x < 25) {
+            x++;
+        } else if (x == 25 && y < 12) {
+            y++;
+        } else if (y == 12 && x > 5) {
+            x--;
+        } else {
+            y--;
+        }
+        memmove(&xs[1], xs, 7 * sizeof(xs[0]));
+        memmove(&ys[1], ys, 7 * sizeof(ys[0]));
+        xs[0] = x;
+        ys[0] = y;
+
+        ssd1306_clear_display(disp);
+        for (int i = 0; i < 8; i++) {
+            ssd1306_fill_rect(disp, xs[i] * 4, ys[i] * 4, 4, 4, SSD1306_WHITE);
+        }
+        ssd1306_fill_rect(disp, 80, 20, 4, 4, SSD1306_WHITE);
+        flush(disp, frames);
+    }
+}
+
+// A log tail on the console, scrolling a line at a time.
+static void work_console(ssd1306_t *disp, unsigned long *frames) {
+    ssd1306_console_init(disp);
+    flush(disp, frames);
+    for (int line = 0; line < 100; line++) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "kernel: event %d\n", line);
+        ssd1306_console_write(disp, buf);
+        flush(disp, frames);
+    }
+}
+
+// A ticker on page 0 redrawn one column per step.
+static void work_ticker(ssd1306_t *disp, unsigned long *frames) {
+    ssd1306_set_cursor(disp, 0, 0);
+    ssd1306_draw_string(disp, "BREAKING: bench runs");
+    flush(disp, frames);
+    for (int step = 0; step < 128; step++) {
+        ssd1306_rotate_region(disp, 0, 0, 0, SSD1306_WIDTH - 1, -1);
+        flush(disp, frames);
+    }
+}
+
+// A 1024x64 canvas of headlines panned one column per frame. Without
+// content scroll every column moves, so the whole panel is resent.
+static void work_hpan(ssd1306_t *disp, unsigned long *frames) {
+    ssd1306_canvas_t *c = ssd1306_canvas_create(disp, 1024, 64, NULL, NULL);
+    if (!c) {
+        return;
+    }
+    for (int line = 0; line < 32; line++) {
+        ssd1306_canvas_draw_text(c, &ssd1306_font_16, (line * 97) % 1024, (line % 4) * 16, "Headline");
+    }
+    for (int x = 0; x <= 128; x++) {
+        ssd1306_canvas_pan(c, x, 0);
+        ssd1306_canvas_render(c);
+        flush(disp, frames);
+    }
+    ssd1306_canvas_destroy(c);
+}
+
+// A 128x512 menu of 64 items panned two rows per frame through the
+// start-line ring.
+static void work_vpan(ssd1306_t *disp, unsigned long *frames) {
+    ssd1306_canvas_t *c = ssd1306_canvas_create(disp, 128, 512, NULL, NULL);
+    if (!c) {
+        return;
+    }
+    for (int item = 0; item < 64; item++) {
+        char label[24];
+        snprintf(label, sizeof(label), "Menu item %d", item);
+        ssd1306_canvas_draw_text(c, &ssd1306_font_8, 4, item * 8, label);
+    }
+    for (int y = 0; y <= 256; y += 2) {
+        ssd1306_canvas_pan(c, 0, y);
+        ssd1306_canvas_render(c);
+        flush(disp, frames);
+    }
+    ssd1306_canvas_destroy(c);
+}
+
+// A 3-bit gray gauge: an 8-step ramp and a level bar that rises each
+// cycle, sent plane by plane. Every plane switch is one frame.
+static void work_gray(ssd1306_t *disp, unsigned long *frames) {
+    ssd1306_gray_t *g = ssd1306_gray_create(disp, 3);
+    if (!g) {
+        return;
+    }
+    for (unsigned level = 0; level < 8; level++) {
+        ssd1306_gray_fill_rect(g, (int)level * 16, 0, 16, 16, level);
+    }
+    for (int cycle = 0; cycle < 30; cycle++) {
+        ssd1306_gray_fill_rect(g, 0, 24, cycle * 4, 8, (unsigned)cycle % 7 + 1);
+        for (int plane = 0; plane < 3; plane++) {
+            ssd1306_gray_step(g);
+            (*frames)++;
+        }
+    }
+    ssd1306_gray_destroy(g);
+}
+
+static const struct {
+    const char *name;
+    workload_fn run;
+} workloads[] = {
+    { "clear", work_clear },
+    { "text", work_text },
+    { "dashboard", work_dashboard },
+    { "widgets", work_widgets },
+    { "snake", work_snake },
+    { "console", work_console },
+    { "ticker", work_ticker },
+    { "hpan", work_hpan },
+    { "vpan", work_vpan },
+    { "gray", work_gray },
+};
+
+// -------------------------------------------------
+// Bus models, replayed from the memory transport's log.
+
+// I2C: every segment is split into messages of a control byte and up to
+// I2C_MAX_MSG - 1 payload bytes, sent in I2C_RDWR batches. A message costs
+// a start condition, the address byte, the control byte and the payload,
+// 9 clocks per byte, plus a stop.
+static void model_i2c(const ssd1306_mem_log_t *log, bench_result_t *r) {
+    size_t seg = 0;
+    for (size_t xfer = 0; xfer < log->xfers; xfer++) {
+        unsigned long msgs = 0;
+        for (; seg < log->nsegs && log->segs[seg].xfer == xfer; seg++) {
+            size_t len = log->segs[seg].len;
+            size_t n = (len + I2C_MAX_MSG - 2) / (I2C_MAX_MSG - 1);
+            msgs += n;
+            r->wire += len + 2 * n;
+            r->bits += 9 * (len + 2 * n) + 2 * n;
+        }
+        r->msgs += msgs;
+        r->syscalls += (msgs + I2C_RDWR_MSGS - 1) / I2C_RDWR_MSGS;
+    }
+}
+
+// SPI: runs of segments of the same kind share SPI_IOC_MESSAGE ioctls of up
+// to SPI_MAX_XFERS transfers and SPI_MAX_MSG bytes; every change of kind
+// also drives the D/C line. 8 clocks per byte.
+static void model_spi(const ssd1306_mem_log_t *log, bench_result_t *r) {
+    int dc = -1;
+    size_t seg = 0;
+    for (size_t xfer = 0; xfer < log->xfers; xfer++) {
+        while (seg < log->nsegs && log->segs[seg].xfer == xfer) {
+            uint8_t ctrl = log->segs[seg].ctrl;
+            if (dc != (ctrl == SSD1306_CTRL_DATA)) {
+                dc = ctrl == SSD1306_CTRL_DATA;
+                r->syscalls++;
+            }
+            size_t nxfers = 0, total = 0, left = log->segs[seg].len;
+            while (seg < log->nsegs && log->segs[seg].xfer == xfer && log->segs[seg].ctrl == ctrl) {
+                if (nxfers == SPI_MAX_XFERS || total == SPI_MAX_MSG) {
+                    r->syscalls++;
+                    nxfers = total = 0;
+                }
+                size_t len = left < SPI_MAX_MSG - total ? left : SPI_MAX_MSG - total;
+                nxfers++;
+                total += len;
+                left -= len;
+                r->msgs++;
+                if (left == 0 && ++seg < log->nsegs) {
+                    left = log->segs[seg].len;
+                }
+            }
+            r->syscalls++;
+        }
+    }
+    r->wire = r->payload;
+    r->bits = 8 * r->payload;
+}
+
+// Private helper: run a workload on a memory display with a cost model.
+static int run(workload_fn fn, const ssd1306_cost_t *cost,
+               void (*model)(const ssd1306_mem_log_t *, bench_result_t *), bench_result_t *r) {
+    ssd1306_t *disp = ssd1306_init_mem();
+    if (!disp) {
+        return -1;
+    }
+    ssd1306_set_cost(disp, cost);
+    ssd1306_flush(disp);
+    ssd1306_mem_reset(disp);
+
+    memset(r, 0, sizeof(*r));
+    fn(disp, &r->frames);
+    const ssd1306_mem_log_t *log = ssd1306_mem_log(disp);
+    r->payload = log->nbytes;
+    r->xfers = log->xfers;
+    model(log, r);
+    ssd1306_close(disp);
+    return 0;
+}
+
+// Private helper: run a workload on an emulated panel. Returns 1 if the
+// controller ends up showing the framebuffer, 0 if not, -1 on error.
+static int verify(workload_fn fn, const char *name, const char *dir) {
+    ssd1306_emu_t *emu = ssd1306_emu_create();
+    if (!emu) {
+        return -1;
+    }
+    ssd1306_t *disp = ssd1306_init_emu(emu);
+    if (!disp) {
+        ssd1306_emu_destroy(emu);
+        return -1;
+    }
+    unsigned long frames = 0;
+    ssd1306_flush(disp);
+    fn(disp, &frames);
+
+    ssd1306_emu_state_t st;
+    ssd1306_emu_get_state(emu, &st);
+    int ok = memcmp(ssd1306_emu_ram(emu), ssd1306_get_buffer(disp), SSD1306_PAGES * SSD1306_WIDTH) == 0 &&
+             st.start_line == ssd1306_get_start_line(disp) && st.display_on;
+    if (dir) {
+        char path[4096];
+        snprintf(path, sizeof(path), "%s/%s.pbm", dir, name);
+        if (ssd1306_emu_write_pbm(emu, path, NULL) < 0) {
+            ok = -1;
+        }
+    }
+    ssd1306_close(disp);
+    ssd1306_emu_destroy(emu);
+    return ok;
+}
+
+static double ms(unsigned long bits, double hz) {
+    return bits * 1000.0 / hz;
+}
+
+int main(int argc, char **argv) {
+    const char *dir = NULL;
+    int opt, failed = 0;
+    while ((opt = getopt(argc, argv, "o:")) != -1) {
+        if (opt != 'o') {
+            fprintf(stderr, "usage: bench [-o dir]\n");
+            return 2;
+        }
+        dir = optarg;
+    }
+
+    // The encoder's cost models for both buses. Relative costs do not
+    // depend on the I2C clock, so one I2C run serves every I2C speed.
+    const ssd1306_cost_t i2c_cost = { .xfer_ns = 30000, .seg_ns = 50000, .byte_ns = 22500 };
+    const ssd1306_cost_t spi_cost = { .xfer_ns = 15000, .seg_ns = 15000, .byte_ns = 1000 };
+
+    printf("%-10s %6s | %8s %6s %6s %6s %8s %8s %8s | %8s %7s %8s | %4s\n",
+           "workload", "frames", "i2c wire", "xfers", "msgs", "ioctls",
+           "100kHz", "400kHz", "1MHz", "spi wire", "sysc", "8MHz", "emu");
+    printf("%-10s %6s | %8s %6s %6s %6s %8s %8s %8s | %8s %7s %8s | %4s\n",
+           "", "", "bytes", "", "", "", "ms", "ms", "ms", "bytes", "", "ms", "");
+
+    for (size_t i = 0; i < sizeof(workloads) / sizeof(workloads[0]); i++) {
+        bench_result_t i2c, spi;
+        if (run(workloads[i].run, &i2c_cost, model_i2c, &i2c) < 0 ||
+            run(workloads[i].run, &spi_cost, model_spi, &spi) < 0) {
+            fprintf(stderr, "bench: Failed to create a memory display\n");
+            return 1;
+        }
+        int ok = verify(workloads[i].run, workloads[i].name, dir);
+        if (ok < 0) {
+            fprintf(stderr, "bench: Failed to emulate %s\n", workloads[i].name);
+            return 1;
+        }
+        failed |= !ok;
+        printf("%-10s %6lu | %8lu %6lu %6lu %6lu %8.1f %8.1f %8.1f | %8lu %7lu %8.2f | %4s\n",
+               workloads[i].name, i2c.frames, i2c.wire, i2c.xfers, i2c.msgs, i2c.syscalls,
+               ms(i2c.bits, 100000), ms(i2c.bits, 400000), ms(i2c.bits, 1000000),
+               spi.wire, spi.syscalls, ms(spi.bits, SPI_HZ), ok ? "ok" : "FAIL");
+    }
+    return failed;
+}
@@ -0,0 +1,274 @@
+// fontc: compile a BDF or PSF font into an ssd1306_font_t C table.
+//
+// Glyphs are stored the way the panel stores pixels: for each glyph,
+// height/8 pages of one byte per column (LSB on top), page after page.
+// Drawing a glyph is then a copy (or shift) of whole column bytes into the
+// framebuffer, with no per-pixel work at run time.
+//
+// Usage: fontc -n NAME [-r FIRST-LAST] [-p] FONT.bdf|FONT.psf > font.c
+//   -n NAME         symbol of the generated const ssd1306_font_t
+//   -r FIRST-LAST   character range to include (default 32-126)
+//   -p              proportional: trim blank columns of monospaced (PSF)
+//                   glyphs and add one spacing column
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define MAX_CHARS 256
+#define MAX_COLS  255
+#define MAX_ROWS  64
+
+typedef struct {
+    int present;
+    int advance;                       // Columns, spacing included.
+    uint8_t px[MAX_ROWS][MAX_COLS];    // Cell pixels, row 0 at the top.
+} glyph_t;
+
+static glyph_t glyphs[MAX_CHARS];
+static int cell_height;
+
+static void die(const char *msg, const char *arg) {
+    fprintf(stderr, "fontc: %s%s%s\n", msg, arg ? ": " : "", arg ? arg : "");
+    exit(1);
+}
+
+// Parse the subset of BDF 2.1 that describes bitmaps and metrics.
+static void load_bdf(FILE *fp, const char *path) {
+    char line[512];
+    int ascent = -1, descent = -1, bbx_h = 0, bbx_yo = 0;
+    int enc = -1, dwidth = -1, w = 0, h = 0, xo = 0, yo = 0;
+    int in_bitmap = 0, row = 0;
+    int have_cell = 0;
+
+    while (fgets(line, sizeof(line), fp)) {
+        if (sscanf(line, "FONT_ASCENT %d", &ascent) == 1 ||
+            sscanf(line, "FONT_DESCENT %d", &descent) == 1) {
+            continue;
+        }
+        if (sscanf(line, "FONTBOUNDINGBOX %*d %d %*d %d", &bbx_h, &bbx_yo) == 2) {
+            continue;
+        }
+        if (strncmp(line, "STARTCHAR", 9) == 0) {
+            if (!have_cell) {
+                if (ascent < 0 || descent < 0) {
+                    ascent = bbx_h + bbx_yo;
+                    descent = -bbx_yo;
+                }
+                cell_height = (ascent + descent + 7) / 8 * 8;
+                if (cell_height <= 0 || cell_height > MAX_ROWS) {
+                    die("unsupported font height", path);
+                }
+                have_cell = 1;
+            }
+            enc = -1;
+            dwidth = -1;
+            w = h = xo = yo = 0;
+            continue;
+        }
+        if (sscanf(line, "ENCODING %d", &enc) == 1 ||
+            sscanf(line, "DWIDTH %d", &dwidth) == 1 ||
+            sscanf(line, "BBX %d %d %d %d", &w, &h, &xo, &yo) == 4) {
+            continue;
+        }
+        if (strncmp(line, "BITMAP", 6) == 0) {
+            in_bitmap = 1;
+            row = 0;
+            if (enc >= 0 && enc < MAX_CHARS) {
+                glyph_t *g = &glyphs[enc];
+                int cols = dwidth >= 0 ? dwidth : xo + w;
+                if (xo + w > cols) {
+                    cols = xo + w;
+                }
+                if (cols > MAX_COLS || xo < 0) {
+                    die("glyph too wide", path);
+                }
+                memset(g, 0, sizeof(*g));
+                g->present = 1;
+                g->advance = cols;
+            }
+            continue;
+        }
+        if (strncmp(line, "ENDCHAR", 7) == 0) {
+            in_bitmap = 0;
+            continue;
+        }
+        if (in_bitmap && enc >= 0 && enc < MAX_CHARS) {
+            glyph_t *g = &glyphs[enc];
+            int y = ascent - (yo + h) + row++;
+            int ndigits = (int)strspn(line, "0123456789abcdefABCDEF");
+            for (int x = 0; x < w && x / 4 < ndigits; x++) {
+                char digit[2] = { line[x / 4], '\0' };
+                int nibble = (int)strtol(digit, NULL, 16);
+                if (y >= 0 && y < cell_height && (nibble >> (3 - x % 4)) & 1) {
+                    g->px[y][xo + x] = 1;
+                }
+            }
+        }
+    }
+    if (!have_cell) {
+        die("no glyphs found", path);
+    }
+}
+
+static uint32_t le32(const uint8_t *p) {
+    return p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+// Load a PSF1 or PSF2 console font. Glyph n is taken as character n.
+static void load_psf(FILE *fp, const char *path) {
+    uint8_t hdr[32];
+    uint32_t count, charsize, height, width, hdrsize;
+
+    if (fread(hdr, 1, 4, fp) != 4) {
+        die("truncated font", path);
+    }
+    if (hdr[0] == 0x36 && hdr[1] == 0x04) {
+        count = (hdr[2] & 0x01) ? 512 : 256;
+        charsize = height = hdr[3];
+        width = 8;
+        hdrsize = 4;
+    } else if (hdr[0] == 0x72 && hdr[1] == 0xb5 && hdr[2] == 0x4a && hdr[3] == 0x86) {
+        if (fread(hdr + 4, 1, 28, fp) != 28) {
+            die("truncated font", path);
+        }
+        hdrsize = le32(hdr + 8);
+        count = le32(hdr + 16);
+        charsize = le32(hdr + 20);
+        height = le32(hdr + 24);
+        width = le32(hdr + 28);
+    } else {
+        die("not a PSF font", path);
+    }
+    if (height == 0 || height > MAX_ROWS || width == 0 || width > MAX_COLS) {
+        die("unsupported glyph size", path);
+    }
+    if (fseek(fp, hdrsize, SEEK_SET) != 0) {
+        die("truncated font", path);
+    }
+
+    uint32_t stride = (width + 7) / 8;
+    uint8_t *buf = malloc(charsize);
+    if (!buf) {
+        die("out of memory", NULL);
+    }
+    cell_height = (int)(height + 7) / 8 * 8;
+    for (uint32_t n = 0; n < count && n < MAX_CHARS; n++) {
+        if (fread(buf, 1, charsize, fp) != charsize) {
+            die("truncated font", path);
+        }
+        glyph_t *g = &glyphs[n];
+        memset(g, 0, sizeof(*g));
+        g->present = 1;
+        g->advance = (int)width;
+        for (uint32_t y = 0; y < height; y++) {
+            for (uint32_t x = 0; x < width; x++) {
+                g->px[y][x] = (buf[y * stride + x / 8] >> (7 - x % 8)) & 1;
+            }
+        }
+    }
+    free(buf);
+}
+
+// Drop blank columns on both sides and leave one spacing column.
+static void make_proportional(glyph_t *g) {
+    int lo = g->advance, hi = -1;
+    for (int x = 0; x < g->advance; x++) {
+        for (int y = 0; y < cell_height; y++) {
+            if (g->px[y][x]) {
+                if (x < lo) {
+                    lo = x;
+                }
+                hi = x;
+            }
+        }
+    }
+    if (hi < 0) {
+        g->advance = (g->advance + 1) / 2; // Blank glyph (space): keep half the cell.
+        return;
+    }
+    for (int y = 0; y < cell_height; y++) {
+        memmove(g->px[y], &g->px[y][lo], (size_t)(hi - lo + 1));
+        memset(&g->px[y][hi - lo + 1], 0, (size_t)(MAX_COLS - (hi - lo + 1)));
+    }
+    g->advance = hi - lo + 2;
+}
+
+int main(int argc, char **argv) {
+    const char *name = NULL, *path = NULL;
+    int first = 32, last = 126, proportional = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            name = argv[++i];
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%d-%d", &first, &last) != 2) {
+                die("bad range", argv[i]);
+            }
+        } else if (strcmp(argv[i], "-p") == 0) {
+            proportional = 1;
+        } else {
+            path = argv[i];
+        }
+    }
+    if (!name || !path || first < 0 || last >= MAX_CHARS || first > last) {
+        fprintf(stderr, "usage: fontc -n NAME [-r FIRST-LAST] [-p] FONT.bdf|FONT.psf\n");
+        return 2;
+    }
+
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        die("cannot open", path);
+    }
+    const char *ext = strrchr(path, '.');
+    if (ext && strcmp(ext, ".bdf") == 0) {
+        load_bdf(fp, path);
+    } else {
+        load_psf(fp, path);
+    }
+    fclose(fp);
+
+    // Characters missing from the source become blank half-cell glyphs.
+    for (int c = first; c <= last; c++) {
+        if (!glyphs[c].present) {
+            glyphs[c].advance = cell_height / 2;
+        } else if (proportional) {
+            make_proportional(&glyphs[c]);
+        }
+    }
+
+    int pages = cell_height / 8;
+    printf("// Generated by fontc from %s. Do not edit.\n\n", path);
+    printf("#include \"ssd1306.h\"\n\n");
+    printf("static const uint8_t bitmap[] = {");
+    unsigned long offset = 0, n = 0;
+    for (int c = first; c <= last; c++) {
+        const glyph_t *g = &glyphs[c];
+        for (int p = 0; p < pages; p++) {
+            for (int x = 0; x < g->advance; x++) {
+                uint8_t byte = 0;
+                for (int b = 0; b < 8; b++) {
+                    byte |= (uint8_t)(g->px[p * 8 + b][x] << b);
+                }
+                printf("%s0x%02X,", n++ % 16 ? " " : "\n    ", byte);
+            }
+        }
+    }
+    printf("\n};\n\nstatic const uint16_t offsets[] = {");
+    for (int c = first; c <= last; c++) {
+        if (offset > UINT16_MAX) {
+            die("font too large for 16-bit offsets", path);
+        }
+        printf("%s%lu,", (c - first) % 12 ? " " : "\n    ", offset);
+        offset += (unsigned long)glyphs[c].advance * pages;
+    }
+    printf("\n};\n\nstatic const uint8_t widths[] = {");
+    for (int c = first; c <= last; c++) {
+        printf("%s%d,", (c - first) % 16 ? " " : "\n    ", glyphs[c].advance);
+    }
+    printf("\n};\n\nconst ssd1306_font_t %s = {\n", name);
+    printf("    .height = %d,\n    .first = %d,\n    .last = %d,\n", cell_height, first, last);
+    printf("    .widths = widths,\n    .offsets = offsets,\n    .bitmap = bitmap,\n};\n");
+    return 0;
+}
@@ -0,0 +1,243 @@
+// oled-play: play grayscale video from standard input on a panel.
+//
+// Input is a stream of binary PGM (P5) images, as written by
+//     ffmpeg -i clip.mp4 -f image2pipe -c:v pgm - | oled-play
+// or raw 8-bit gray frames of a size given with -s:
+//     ffmpeg -i clip.mp4 -vf scale=128:64 -pix_fmt gray -f rawvideo - | oled-play -s 128x64
+// Frames are scaled to fit the panel, keeping their aspect ratio, and
+// dithered. A flush worker sends each frame while the next one is read and
+// dithered; when input outruns the bus, the panel shows the newest frame
+// and skips the rest, so playback runs at whatever rate the bus sustains.
+//
+// Usage: oled-play [-d i2c-dev] [-a addr] [-g WxH] [-s WxH] [-m method] [-r fps] [-n]
+//   -m: bayer (default), floyd or threshold
+//   -r: play at most fps frames per second (default: as fast as input comes)
+//   -n: no panel; run the pipeline without a bus and report throughput
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "ssd1306.h"
+
+// Largest input frame accepted.
+#define MAX_SIDE 4096
+
+static volatile sig_atomic_t stop;
+
+static void on_signal(int sig) {
+    (void)sig;
+    stop = 1;
+}
+
+static const struct {
+    const char *name;
+    const ssd1306_geometry_t *geom;
+} panels[] = {
+    { "128x64", &ssd1306_128x64 },
+    { "128x32", &ssd1306_128x32 },
+    { "72x40", &ssd1306_72x40 },
+    { "64x48", &ssd1306_64x48 },
+};
+
+static const char *const methods[] = { "threshold", "bayer", "floyd" };
+
+static void usage(void) {
+    fprintf(stderr, "usage: oled-play [-d i2c-dev] [-a addr] [-g WxH] [-s WxH] [-m method] [-r fps] [-n]\n"
+                    "  -g: 128x64 (default), 128x32, 72x40 or 64x48\n"
+                    "  -s: size of raw input frames; without it, input is PGM\n"
+                    "  -m: bayer (default), floyd or threshold\n");
+    exit(2);
+}
+
+// Transport of -n: accepts every byte and sends none.
+static int discard(void *user, uint8_t ctrl, const uint8_t *buf, size_t len) {
+    (void)user;
+    (void)ctrl;
+    (void)buf;
+    (void)len;
+    return 0;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Private helper: read one PGM header number, skipping whitespace and comments.
+static int pgm_number(FILE *fp) {
+    int c, n = 0, digits = 0;
+    while ((c = getc(fp)) != EOF) {
+        if (c == '#') {
+            while ((c = getc(fp)) != EOF && c != '\n') {
+            }
+        } else if (c >= '0' && c <= '9') {
+            n = n * 10 + (c - '0');
+            digits++;
+            if (n > 65535) {
+                return -1;
+            }
+        } else if (digits) {
+            break;
+        }
+    }
+    return digits ? n : -1;
+}
+
+// Private helper: read a PGM header. Returns 1 on success, 0 at the end of
+// the stream, -1 on a malformed or unsupported image.
+static int pgm_header(FILE *fp, int *w, int *h) {
+    int c = getc(fp);
+    if (c == EOF) {
+        return 0;
+    }
+    if (c != 'P' || getc(fp) != '5') {
+        return -1;
+    }
+    *w = pgm_number(fp);
+    *h = pgm_number(fp);
+    int maxval = pgm_number(fp);
+    return *w > 0 && *h > 0 && *w <= MAX_SIDE && *h <= MAX_SIDE && maxval == 255 ? 1 : -1;
+}
+
+int main(int argc, char **argv) {
+    const char *dev = "/dev/i2c-1";
+    const ssd1306_geometry_t *geom = &ssd1306_128x64;
+    unsigned long addr = 0x3C;
+    int raw_w = 0, raw_h = 0, method = SSD1306_DITHER_BAYER, dry = 0;
+    double fps = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:a:g:s:m:r:n")) != -1) {
+        switch (opt) {
+        case 'd':
+            dev = optarg;
+            break;
+        case 'a':
+            addr = strtoul(optarg, NULL, 0);
+            break;
+        case 'g':
+            geom = NULL;
+            for (size_t i = 0; i < sizeof(panels) / sizeof(panels[0]); i++) {
+                if (strcmp(optarg, panels[i].name) == 0) {
+                    geom = panels[i].geom;
+                }
+            }
+            if (!geom) {
+                usage();
+            }
+            break;
+        case 's':
+            if (sscanf(optarg, "%dx%d", &raw_w, &raw_h) != 2 || raw_w <= 0 || raw_h <= 0 ||
+                raw_w > MAX_SIDE || raw_h > MAX_SIDE) {
+                usage();
+            }
+            break;
+        case 'm':
+            method = -1;
+            for (int i = 0; i < 3; i++) {
+                if (strcmp(optarg, methods[i]) == 0) {
+                    method = i;
+                }
+            }
+            if (method < 0) {
+                usage();
+            }
+            break;
+        case 'r':
+            fps = atof(optarg);
+            break;
+        case 'n':
+            dry = 1;
+            break;
+        default:
+            usage();
+        }
+    }
+    if (addr > 0x7F || fps < 0) {
+        usage();
+    }
+
+    ssd1306_t *disp = dry ? ssd1306_init_callback(discard, NULL) : ssd1306_init(dev, (uint8_t)addr);
+    if (!disp) {
+        return 1;
+    }
+    if (ssd1306_set_geometry(disp, geom) < 0 || ssd1306_async_start(disp) < 0) {
+        ssd1306_close(disp);
+        return 1;
+    }
+
+    struct sigaction sa = { .sa_handler = on_signal };
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    uint8_t *frame = NULL;
+    size_t frame_size = 0;
+    unsigned long frames = 0;
+    double t0 = now_s(), next = t0;
+    int ret = 0;
+    while (!stop) {
+        int w = raw_w, h = raw_h;
+        if (!raw_w) {
+            int r = pgm_header(stdin, &w, &h);
+            if (r <= 0) {
+                if (r < 0) {
+                    fprintf(stderr, "oled-play: Input is not an 8-bit binary PGM stream\n");
+                    ret = 1;
+                }
+                break;
+            }
+        }
+        if ((size_t)w * h > frame_size) {
+            uint8_t *grown = realloc(frame, (size_t)w * h);
+            if (!grown) {
+                perror("oled-play: Failed to allocate frame");
+                ret = 1;
+                break;
+            }
+            frame = grown;
+            frame_size = (size_t)w * h;
+        }
+        if (fread(frame, 1, (size_t)w * h, stdin) != (size_t)w * h) {
+            break;
+        }
+
+        // Fit the frame to the panel, keeping its aspect ratio.
+        int dw = geom->width, dh = (int)((long)h * geom->width / w);
+        if (dh > geom->height) {
+            dh = geom->height;
+            dw = (int)((long)w * geom->height / h);
+        }
+        if (dw < 1 || dh < 1) {
+            continue;
+        }
+
+        if (fps > 0) {
+            next += 1 / fps;
+            double wait = next - now_s();
+            if (wait > 0) {
+                struct timespec ts = { (time_t)wait, (long)((wait - (time_t)wait) * 1e9) };
+                nanosleep(&ts, NULL);
+            }
+        }
+        ssd1306_draw_gray(disp, (geom->width - dw) / 2, (geom->height - dh) / 2, dw, dh,
+                          frame, w, h, (size_t)w, method);
+        ssd1306_flush(disp);
+        frames++;
+    }
+
+    ssd1306_async_stop(disp);
+    double elapsed = now_s() - t0;
+    ssd1306_stats_t st;
+    ssd1306_get_stats(disp, &st);
+    fprintf(stderr, "oled-play: %lu frames in %.2f s (%.1f fps), %llu sent to the panel, %llu skipped\n",
+            frames, elapsed, elapsed > 0 ? frames / elapsed : 0.0,
+            (unsigned long long)st.frames, (unsigned long long)st.frames_dropped);
+
+    free(frame);
+    ssd1306_close(disp);
+    return ret;
+}
@@ -0,0 +1,100 @@
+// oledd: own a panel and share it between processes.
+//
+// Clients connect with ssd1306_init_client() and draw as if they had the
+// panel to themselves; oledd composites their layers and flushes the
+// result at most once per refresh tick.
+//
+// Usage: oledd [-d i2c-dev] [-a addr] [-g WxH] [-r hz] [-s socket]
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "ssd1306.h"
+
+static ssd1306_server_t *server;
+
+static void on_signal(int sig) {
+    (void)sig;
+    ssd1306_server_stop(server);
+}
+
+static const struct {
+    const char *name;
+    const ssd1306_geometry_t *geom;
+} panels[] = {
+    { "128x64", &ssd1306_128x64 },
+    { "128x32", &ssd1306_128x32 },
+    { "72x40", &ssd1306_72x40 },
+    { "64x48", &ssd1306_64x48 },
+};
+
+static void usage(void) {
+    fprintf(stderr, "usage: oledd [-d i2c-dev] [-a addr] [-g WxH] [-r hz] [-s socket]\n"
+                    "  -g: 128x64 (default), 128x32, 72x40 or 64x48\n");
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    const char *dev = "/dev/i2c-1", *path = "/run/oledd.sock";
+    const ssd1306_geometry_t *geom = &ssd1306_128x64;
+    unsigned long addr = 0x3C, hz = 30;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:a:g:r:s:")) != -1) {
+        switch (opt) {
+        case 'd':
+            dev = optarg;
+            break;
+        case 'a':
+            addr = strtoul(optarg, NULL, 0);
+            break;
+        case 'g':
+            geom = NULL;
+            for (size_t i = 0; i < sizeof(panels) / sizeof(panels[0]); i++) {
+                if (strcmp(optarg, panels[i].name) == 0) {
+                    geom = panels[i].geom;
+                }
+            }
+            if (!geom) {
+                usage();
+            }
+            break;
+        case 'r':
+            hz = strtoul(optarg, NULL, 0);
+            break;
+        case 's':
+            path = optarg;
+            break;
+        default:
+            usage();
+        }
+    }
+    if (addr > 0x7F || hz == 0 || hz > 1000) {
+        usage();
+    }
+
+    ssd1306_t *disp = ssd1306_init(dev, (uint8_t)addr);
+    if (!disp) {
+        return 1;
+    }
+    if (ssd1306_set_geometry(disp, geom) < 0 ||
+        !(server = ssd1306_server_create(disp, path, (unsigned)hz))) {
+        ssd1306_close(disp);
+        return 1;
+    }
+    ssd1306_flush(disp);
+
+    struct sigaction sa = { .sa_handler = on_signal };
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    int ret = ssd1306_server_run(server);
+
+    ssd1306_server_destroy(server);
+    ssd1306_clear_display(disp);
+    ssd1306_flush(disp);
+    ssd1306_close(disp);
+    return ret < 0;
+}